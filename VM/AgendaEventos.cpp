@@ -0,0 +1,132 @@
+#include "AgendaEventos.h"
+#include <algorithm>
+#include <bit>
+
+/*
+=========================================================================================
+Agendar um evento. Instantes que já passaram disparam na próxima verificação.
+=========================================================================================
+*/
+std::uint64_t AgendaEventos::agendar(std::uint64_t instante, Acao acao) {
+    instante = std::max(instante, m_base);
+    std::uint64_t id = m_proximo_id++;
+    m_pendentes.insert(id);
+    inserir(Evento{instante, id, std::move(acao)});
+    m_proximo = std::min(m_proximo, instante);
+    return id;
+}
+
+// O evento continua na roda (ou no heap) e é descartado quando sua posição vencer
+bool AgendaEventos::cancelar(std::uint64_t id) {
+    return m_pendentes.erase(id) > 0;
+}
+
+void AgendaEventos::limpar() {
+    for (auto& posicao : m_roda) {
+        posicao.clear();
+    }
+    m_ocupadas.fill(0);
+    m_distantes.clear();
+    m_pendentes.clear();
+    m_base = 0;
+    m_proximo = SEM_EVENTO;
+}
+
+void AgendaEventos::inserir(Evento evento) {
+    if (evento.instante - m_base < POSICOES) {
+        std::size_t posicao = evento.instante % POSICOES;
+        m_roda[posicao].push_back(std::move(evento));
+        m_ocupadas[posicao / 64] |= std::uint64_t(1) << (posicao % 64);
+    } else {
+        m_distantes.push_back(std::move(evento));
+        std::push_heap(m_distantes.begin(), m_distantes.end(), MaisTarde{});
+    }
+}
+
+// Move a janela da roda para começar em 'agora' e traz do heap o que passou a caber nela
+void AgendaEventos::avancarBase(std::uint64_t agora) {
+    m_base = agora;
+    while (!m_distantes.empty() && m_distantes.front().instante - m_base < POSICOES) {
+        std::pop_heap(m_distantes.begin(), m_distantes.end(), MaisTarde{});
+        Evento evento = std::move(m_distantes.back());
+        m_distantes.pop_back();
+        inserir(std::move(evento));
+    }
+}
+
+/*
+=========================================================================================
+Disparar os eventos vencidos. Cada posição da roda guarda um único instante, pois a
+janela tem exatamente POSICOES instantes a partir de m_base.
+=========================================================================================
+*/
+void AgendaEventos::disparar(std::uint64_t agora) {
+    while (m_proximo <= agora) {
+        std::uint64_t instante = m_proximo;
+        avancarBase(instante);
+
+        std::size_t posicao = instante % POSICOES;
+        std::vector<Evento> vencidos;
+        vencidos.swap(m_roda[posicao]);
+        m_ocupadas[posicao / 64] &= ~(std::uint64_t(1) << (posicao % 64));
+
+        // os que vieram do heap chegam fora de ordem; o id preserva a ordem de agendamento
+        std::sort(vencidos.begin(), vencidos.end(),
+                  [](const Evento& a, const Evento& b) { return a.id < b.id; });
+
+        m_proximo = SEM_EVENTO; // a posição foi esvaziada; agendar() pode trazê-lo de volta
+        recalcularProximo();
+        for (Evento& evento : vencidos) {
+            if (m_pendentes.erase(evento.id) > 0) {
+                evento.acao();
+            }
+        }
+    }
+}
+
+void AgendaEventos::descartarCancelados() {
+    auto cancelado = [this](const Evento& evento) { return !m_pendentes.contains(evento.id); };
+    while (m_proximo != SEM_EVENTO) {
+        if (m_proximo - m_base < POSICOES) {
+            std::size_t posicao = m_proximo % POSICOES;
+            std::erase_if(m_roda[posicao], cancelado);
+            if (!m_roda[posicao].empty()) {
+                return;
+            }
+            m_ocupadas[posicao / 64] &= ~(std::uint64_t(1) << (posicao % 64));
+        } else {
+            if (!cancelado(m_distantes.front())) {
+                return;
+            }
+            std::pop_heap(m_distantes.begin(), m_distantes.end(), MaisTarde{});
+            m_distantes.pop_back();
+        }
+        m_proximo = SEM_EVENTO;
+        recalcularProximo();
+    }
+}
+
+// Primeira posição ocupada a partir de m_base (circular), ou o topo do heap
+void AgendaEventos::recalcularProximo() {
+    constexpr std::size_t PALAVRAS = POSICOES / 64;
+    std::size_t inicio = m_base % POSICOES;
+
+    for (std::size_t i = 0; i <= PALAVRAS; ++i) {
+        std::size_t palavra = (inicio / 64 + i) % PALAVRAS;
+        std::uint64_t bits = m_ocupadas[palavra];
+        if (i == 0) {
+            bits &= ~std::uint64_t(0) << (inicio % 64);
+        } else if (i == PALAVRAS) {
+            bits &= (std::uint64_t(1) << (inicio % 64)) - 1; // o resto da primeira palavra
+        }
+        if (bits != 0) {
+            std::size_t posicao = palavra * 64 + std::countr_zero(bits);
+            std::uint64_t candidato = m_base + (posicao + POSICOES - inicio) % POSICOES;
+            m_proximo = std::min(m_proximo, candidato);
+            return;
+        }
+    }
+    if (!m_distantes.empty()) {
+        m_proximo = std::min(m_proximo, m_distantes.front().instante);
+    }
+}
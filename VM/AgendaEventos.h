@@ -0,0 +1,64 @@
+#ifndef VM_SIC_AGENDAEVENTOS_H
+#define VM_SIC_AGENDAEVENTOS_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <unordered_set>
+#include <vector>
+
+// Agenda de eventos discretos cujo relógio é o tempo simulado da máquina (instruções
+// executadas mais o tempo saltado com a máquina ociosa). Os eventos próximos ficam numa roda de 256 posições com um mapa de
+// bits de ocupação; os distantes esperam num heap e descem para a roda quando ela chega
+// perto. A máquina só compara o contador com proximoPrazo() a cada passo.
+class AgendaEventos {
+public:
+    using Acao = std::function<void()>;
+    static constexpr std::uint64_t SEM_EVENTO = std::numeric_limits<std::uint64_t>::max();
+
+private:
+    static constexpr std::size_t POSICOES = 256;
+
+    struct Evento {
+        std::uint64_t instante;
+        std::uint64_t id;
+        Acao acao;
+    };
+    struct MaisTarde {
+        bool operator()(const Evento& a, const Evento& b) const {
+            return a.instante != b.instante ? a.instante > b.instante : a.id > b.id;
+        }
+    };
+
+    std::array<std::vector<Evento>, POSICOES> m_roda;
+    std::array<std::uint64_t, POSICOES / 64> m_ocupadas{}; // posição da roda com eventos
+    std::vector<Evento> m_distantes; // heap (std::push_heap) ordenado por MaisTarde
+    std::unordered_set<std::uint64_t> m_pendentes; // ids ainda não disparados nem cancelados
+    std::uint64_t m_base = 0;                      // a roda cobre [m_base, m_base + POSICOES)
+    std::uint64_t m_proximo = SEM_EVENTO;
+    std::uint64_t m_proximo_id = 1;
+
+    void inserir(Evento evento);
+    void avancarBase(std::uint64_t agora);
+    void recalcularProximo();
+
+public:
+    // Agenda 'acao' para quando o contador chegar a 'instante'; retorna um id para cancelar
+    std::uint64_t agendar(std::uint64_t instante, Acao acao);
+    bool cancelar(std::uint64_t id);
+    void limpar();
+
+    // Executa, em ordem de instante (e de agendamento), tudo que vence até 'agora'.
+    // As ações podem agendar novos eventos, inclusive para o mesmo instante.
+    void disparar(std::uint64_t agora);
+
+    // Instante do primeiro evento ainda na agenda, que pode ter sido cancelado
+    std::uint64_t proximoPrazo() const { return m_proximo; }
+    // Tira da frente os eventos cancelados: depois disso proximoPrazo() é o de um evento
+    // que vai disparar (ou SEM_EVENTO)
+    void descartarCancelados();
+    bool vazia() const { return m_pendentes.empty(); }
+};
+
+#endif //VM_SIC_AGENDAEVENTOS_H
@@ -0,0 +1,109 @@
+#include "BatchRunner.h"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+
+BatchRunner::BatchRunner(unsigned num_threads) : m_num_threads(std::max(1u, num_threads)) {}
+
+/*
+=========================================================================================
+Executar um único trabalho do começo ao fim em uma Maquina própria.
+=========================================================================================
+*/
+ResultadoLote BatchRunner::executarTrabalho(const TrabalhoLote& trabalho) {
+    ResultadoLote resultado;
+
+    // uma exceção aqui (imagem inválida, dispositivo, falta de memória) vira o resultado
+    // deste trabalho; escapando da thread do lote, derrubaria todos os outros
+    try {
+        Maquina vm(trabalho.tamanho_memoria);
+        vm.setLog(nullptr); // o rastreamento por instrução só atrapalha em lote
+        if (trabalho.imagem) {
+            vm.carregarImagem(trabalho.imagem);
+        }
+        vm.getCPU().r = trabalho.estado_inicial;
+
+        resultado.falha = vm.executar(trabalho.limite_instrucoes);
+        resultado.erro = vm.getErro();
+        resultado.instrucoes = vm.getContadorInstrucoes();
+        resultado.regs = vm.getCPU().r;
+
+        // faixas fora da memória são truncadas em vez de gerar erro
+        const Memoria& memoria = vm.getMemoria();
+        for (const auto& [inicio, tamanho] : trabalho.faixas) {
+            std::size_t ini = std::min(inicio, memoria.getTamanhoBytes());
+            std::size_t fim = std::min(ini + tamanho, memoria.getTamanhoBytes());
+            resultado.faixas.push_back(memoria.getBytes(ini, fim - ini));
+        }
+    } catch (const std::exception& e) {
+        resultado.falha = Falha::EXCECAO;
+        resultado.erro = e.what();
+    } catch (...) {
+        resultado.falha = Falha::EXCECAO;
+        resultado.erro = "Excecao desconhecida no trabalho do lote.";
+    }
+
+    return resultado;
+}
+
+/*
+=========================================================================================
+Distribuir os trabalhos entre as filas das threads. Cada thread consome do fim da
+própria fila e, quando ela esvazia, rouba do início da fila das outras.
+=========================================================================================
+*/
+std::vector<ResultadoLote> BatchRunner::executar(const std::vector<TrabalhoLote>& trabalhos) const {
+    std::vector<ResultadoLote> resultados(trabalhos.size());
+    if (trabalhos.empty()) {
+        return resultados;
+    }
+
+    struct Fila {
+        std::mutex mtx;
+        std::deque<std::size_t> itens;
+    };
+
+    const std::size_t num_threads = std::min<std::size_t>(m_num_threads, trabalhos.size());
+    std::vector<Fila> filas(num_threads);
+
+    // blocos contíguos por thread; o roubo equilibra trabalhos de duração desigual
+    for (std::size_t i = 0; i < trabalhos.size(); ++i) {
+        filas[i * num_threads / trabalhos.size()].itens.push_back(i);
+    }
+
+    auto proximo = [&filas, num_threads](std::size_t id, std::size_t& indice) -> bool {
+        {
+            std::lock_guard<std::mutex> trava(filas[id].mtx);
+            if (!filas[id].itens.empty()) {
+                indice = filas[id].itens.back();
+                filas[id].itens.pop_back();
+                return true;
+            }
+        }
+        for (std::size_t k = 1; k < num_threads; ++k) {
+            Fila& vitima = filas[(id + k) % num_threads];
+            std::lock_guard<std::mutex> trava(vitima.mtx);
+            if (!vitima.itens.empty()) {
+                indice = vitima.itens.front();
+                vitima.itens.pop_front();
+                return true;
+            }
+        }
+        return false; // nenhum trabalho novo entra durante o lote, então acabou
+    };
+
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(num_threads);
+        for (std::size_t id = 0; id < num_threads; ++id) {
+            threads.emplace_back([&, id] {
+                std::size_t indice;
+                while (proximo(id, indice)) {
+                    resultados[indice] = executarTrabalho(trabalhos[indice]);
+                }
+            });
+        }
+    } // jthread faz join ao sair do escopo
+
+    return resultados;
+}
@@ -0,0 +1,41 @@
+#ifndef VM_SIC_BATCHRUNNER_H
+#define VM_SIC_BATCHRUNNER_H
+
+#include "Maquina_melhor.h"
+#include <memory>
+#include <thread>
+#include <utility>
+
+// Um trabalho do lote: programa, estado inicial e orçamento de instruções
+struct TrabalhoLote {
+    std::shared_ptr<const ImagemCompartilhada> imagem; // mapeada a partir do endereço 0, sem cópia
+    Registradores estado_inicial;                            // PC incluído
+    std::uint64_t limite_instrucoes = std::numeric_limits<std::uint64_t>::max();
+    std::size_t tamanho_memoria = MEMORIA_TAMANHO;           // em palavras, como em Maquina
+    std::vector<std::pair<std::size_t, std::size_t>> faixas; // (endereço de byte, tamanho) a devolver
+};
+
+struct ResultadoLote {
+    Registradores regs;                            // registradores finais
+    std::vector<std::vector<std::uint8_t>> faixas; // conteúdo das faixas pedidas, na mesma ordem
+    Falha falha = Falha::NENHUMA;
+    std::string erro;
+    std::uint64_t instrucoes = 0;
+};
+
+// Executa vários trabalhos em paralelo, uma Maquina por trabalho, com roubo de tarefas
+// entre as threads. Os resultados voltam na mesma ordem dos trabalhos.
+class BatchRunner {
+private:
+    unsigned m_num_threads;
+
+public:
+    explicit BatchRunner(unsigned num_threads = std::thread::hardware_concurrency());
+
+    std::vector<ResultadoLote> executar(const std::vector<TrabalhoLote>& trabalhos) const;
+
+    // Não lança: uma exceção durante o trabalho volta como Falha::EXCECAO e a mensagem em 'erro'
+    static ResultadoLote executarTrabalho(const TrabalhoLote& trabalho);
+};
+
+#endif //VM_SIC_BATCHRUNNER_H
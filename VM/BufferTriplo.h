@@ -0,0 +1,42 @@
+#ifndef VM_SIC_BUFFERTRIPLO_H
+#define VM_SIC_BUFFERTRIPLO_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Buffer triplo sem travas entre um produtor e um consumidor. O produtor preenche
+// escrita() e publica; o consumidor pega a publicação mais recente e lê leitura() à
+// vontade. Cada lado tem sua cópia e a terceira fica no meio, trocada por um exchange,
+// então nenhum dos dois espera o outro e o consumidor nunca vê uma cópia pela metade.
+// Publicações que o consumidor não chegou a pegar são substituídas pela seguinte.
+template <typename T>
+class BufferTriplo {
+private:
+    static constexpr std::uint8_t INDICE = 0x3;
+    static constexpr std::uint8_t NOVO = 0x4; // o índice do meio ainda não foi lido
+
+    std::array<T, 3> m_copias{};
+    alignas(64) std::atomic<std::uint8_t> m_meio{1};
+    alignas(64) std::uint8_t m_escrita = 0; // só o produtor usa
+    alignas(64) std::uint8_t m_leitura = 2; // só o consumidor usa
+
+public:
+    // Produtor
+    T& escrita() { return m_copias[m_escrita]; }
+    void publicar() {
+        m_escrita = m_meio.exchange(m_escrita | NOVO, std::memory_order_acq_rel) & INDICE;
+    }
+
+    // Consumidor: troca leitura() pela última publicação; false se não houve nenhuma nova
+    bool atualizar() {
+        if (!(m_meio.load(std::memory_order_relaxed) & NOVO)) {
+            return false;
+        }
+        m_leitura = m_meio.exchange(m_leitura, std::memory_order_acq_rel) & INDICE;
+        return true;
+    }
+    const T& leitura() const { return m_copias[m_leitura]; }
+};
+
+#endif //VM_SIC_BUFFERTRIPLO_H
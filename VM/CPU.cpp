@@ -2,4 +2,71 @@
 // Created by jsfonseca on 21/10/2025.
 //
 
-#include "CPU.h"
\ No newline at end of file
+#include "CPU.h"
+#include <cmath>
+
+/*
+=========================================================================================
+Montar e desmontar a palavra de status. O CC usa a codificação do SIC/XE:
+00 = menor, 01 = igual, 10 = maior.
+=========================================================================================
+*/
+std::uint32_t montarPalavraStatus(const Registradores& r, std::uint8_t id_cpu) {
+    std::uint32_t cc = r.SW == SMALLER ? 0 : (r.SW == EQUAL ? 1 : 2);
+    return (std::uint32_t{r.modo & 1u} << 23) |
+           (std::uint32_t{id_cpu & 0xFu} << 18) |
+           (cc << 16) |
+           (std::uint32_t{r.mascara & 0xFu} << 12) |
+           r.icode;
+}
+
+void carregarPalavraStatus(Registradores& r, std::uint32_t palavra) {
+    r.modo = (palavra >> 23) & 1;
+    std::uint32_t cc = (palavra >> 16) & 3;
+    r.SW = cc == 0 ? SMALLER : (cc == 1 ? EQUAL : BIGGER);
+    r.mascara = (palavra >> 12) & 0xF;
+    r.icode = palavra & 0xFF;
+}
+
+/*
+=========================================================================================
+Conversão entre o double usado nas contas e o formato de 48 bits da memória.
+=========================================================================================
+*/
+std::uint64_t empacotarFlutuante(double valor) {
+    if (valor == 0.0 || std::isnan(valor)) {
+        return 0;
+    }
+    std::uint64_t sinal = std::signbit(valor) ? std::uint64_t{1} << 47 : 0;
+    constexpr std::uint64_t MAIOR = (std::uint64_t{0x7FF} << 36) | ((std::uint64_t{1} << 36) - 1);
+    if (std::isinf(valor)) {
+        return sinal | MAIOR;
+    }
+
+    int expoente;
+    double mantissa = std::frexp(std::fabs(valor), &expoente); // [0,5; 1)
+    std::uint64_t fracao = static_cast<std::uint64_t>(std::llround(std::ldexp(mantissa, 36)));
+    if (fracao == std::uint64_t{1} << 36) { // o arredondamento passou de 1
+        fracao >>= 1;
+        ++expoente;
+    }
+
+    int campo = expoente + 1024;
+    if (campo > 0x7FF) {
+        return sinal | MAIOR;
+    }
+    if (campo < 0) {
+        return 0;
+    }
+    return sinal | (std::uint64_t(campo) << 36) | fracao;
+}
+
+double desempacotarFlutuante(std::uint64_t bits) {
+    std::uint64_t fracao = bits & ((std::uint64_t{1} << 36) - 1);
+    if (fracao == 0) {
+        return 0.0;
+    }
+    int campo = static_cast<int>((bits >> 36) & 0x7FF);
+    double valor = std::ldexp(static_cast<double>(fracao), campo - 1024 - 36);
+    return (bits >> 47) & 1 ? -valor : valor;
+}
@@ -9,6 +9,15 @@
 enum RegID {A = 0, X = 1, L = 2, B = 3, S = 4, T = 5, F = 6, PC = 8, SW = 9};
 enum status {BIGGER = 1, EQUAL = 0, SMALLER = -1};
 
+// Classes de interrupção do SIC/XE, em ordem de prioridade
+enum class ClasseInterrupcao {SVC = 0, PROGRAMA = 1, TEMPORIZADOR = 2, ES = 3};
+
+// Bits do campo MASK da palavra de status (1 = classe habilitada)
+constexpr std::uint8_t MASCARA_SVC = 0x8;
+constexpr std::uint8_t MASCARA_PROGRAMA = 0x4;
+constexpr std::uint8_t MASCARA_TEMPORIZADOR = 0x2;
+constexpr std::uint8_t MASCARA_ES = 0x1;
+
 struct Registradores {;
     std::int32_t A = 0;  // Acumulador
     std::int32_t PC = 0; // Contador de programa
@@ -20,11 +29,29 @@ struct Registradores {;
 
     std::int32_t S = 0;  // Registrador geral S
     std::int32_t T = 0;  // Registrador geral T
+    double F = 0.0;      // Ponto flutuante (48 bits na memória, double do hospedeiro aqui)
+
+    // Demais campos da palavra de status do SIC/XE (o código de condição é o SW acima)
+    std::uint8_t modo = 1;    // 1 = supervisor, 0 = usuário
+    std::uint8_t mascara = 0; // MASCARA_*: classes de interrupção habilitadas
+    std::uint8_t icode = 0;   // código da última interrupção
 };
 
+// Palavra de status de 24 bits no formato do SIC/XE (bit 0 = mais significativo):
+// MODE (0), IDLE (1), ID (2-5), CC (6-7), MASK (8-11), ICODE (16-23)
+std::uint32_t montarPalavraStatus(const Registradores& r, std::uint8_t id_cpu);
+void carregarPalavraStatus(Registradores& r, std::uint32_t palavra);
+
+// Formato de ponto flutuante de 48 bits do SIC/XE: sinal (bit 47), expoente de 11 bits
+// em excesso de 1024 e fração de 36 bits normalizada (valor = 0,fração × 2^(exp - 1024)).
+// Zero é tudo zero; valores fora da faixa saturam no maior módulo ou viram zero.
+std::uint64_t empacotarFlutuante(double valor);
+double desempacotarFlutuante(std::uint64_t bits);
+
 class CPU {
 public:
     Registradores r;
+    std::uint8_t id = 0; // Número da CPU em uma máquina com várias CPUs (lido por IDCPU)
 };
 
 
@@ -0,0 +1,65 @@
+#include "CacheDesmontagem.h"
+#include "Decodificador.h"
+
+CacheDesmontagem::CacheDesmontagem(const Memoria& memoria) : m_memoria(memoria), m_linhas(ENTRADAS) {
+}
+
+const CacheDesmontagem::Linha& CacheDesmontagem::linha(std::uint32_t endereco) {
+    Linha& linha = m_linhas[endereco % ENTRADAS];
+    if (linha.endereco == endereco) {
+        return linha;
+    }
+
+    for (std::size_t k = 0; k < linha.bytes.size(); ++k) {
+        linha.bytes[k] = m_memoria.getByte(endereco + k);
+    }
+    const InstrucaoDecodificada* imagem = m_memoria.decodificadaCompartilhada(endereco);
+    const InstrucaoDecodificada inst = imagem ? *imagem
+                                              : decodificar(linha.bytes[0], linha.bytes[1], linha.bytes[2], linha.bytes[3]);
+    linha.endereco = endereco;
+    linha.tamanho = inst.tamanho;
+    linha.texto = desmontar(inst, endereco);
+    return linha;
+}
+
+const CacheDesmontagem::Linha* CacheDesmontagem::linhaEmCache(std::uint32_t endereco) const {
+    const Linha& linha = m_linhas[endereco % ENTRADAS];
+    return linha.endereco == endereco ? &linha : nullptr;
+}
+
+std::uint32_t CacheDesmontagem::inicioDaInstrucao(std::uint32_t endereco) {
+    std::uint32_t inicio = endereco & ~static_cast<std::uint32_t>(PAGINA_MASCARA);
+    while (true) {
+        const std::uint32_t proxima = inicio + linha(inicio).tamanho;
+        if (proxima > endereco) {
+            return inicio;
+        }
+        inicio = proxima;
+    }
+}
+
+std::uint32_t CacheDesmontagem::anterior(std::uint32_t endereco) {
+    return endereco == 0 ? 0 : inicioDaInstrucao(endereco - 1);
+}
+
+void CacheDesmontagem::invalidar(std::uint32_t endereco) {
+    // instruções de até 4 bytes começando em endereco-3 .. endereco contêm o byte
+    for (std::uint32_t k = 0; k < 4 && k <= endereco; ++k) {
+        Linha& linha = m_linhas[(endereco - k) % ENTRADAS];
+        if (linha.endereco == endereco - k) {
+            linha.endereco = VAZIA;
+        }
+    }
+}
+
+void CacheDesmontagem::invalidar(const std::vector<std::uint32_t>& enderecos) {
+    for (std::uint32_t endereco : enderecos) {
+        invalidar(endereco);
+    }
+}
+
+void CacheDesmontagem::invalidarTudo() {
+    for (Linha& linha : m_linhas) {
+        linha.endereco = VAZIA;
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef VM_SIC_CACHEDESMONTAGEM_H
+#define VM_SIC_CACHEDESMONTAGEM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Memoria.h"
+
+// Linhas de desmontagem já prontas, por endereço, para a visão de desmontagem da GUI.
+// Cache de mapeamento direto com ENTRADAS posições: tamanho fixo, e uma escrita
+// invalida no máximo as 4 posições das instruções que podem conter o byte escrito.
+// A decodificação é a mesma da execução (decodificar/desmontar, e as instruções já
+// decodificadas da imagem carregada quando a página ainda é a dela).
+class CacheDesmontagem {
+public:
+    static constexpr std::size_t ENTRADAS = 4096;
+    static constexpr std::uint32_t VAZIA = 0xFFFFFFFF;
+
+    struct Linha {
+        std::uint32_t endereco = VAZIA;
+        std::uint8_t tamanho = 0;
+        std::array<std::uint8_t, 4> bytes{};
+        std::string texto;
+    };
+
+private:
+    const Memoria& m_memoria;
+    std::vector<Linha> m_linhas; // posição = endereço % ENTRADAS
+
+public:
+    explicit CacheDesmontagem(const Memoria& memoria);
+
+    // Linha da instrução que começa em 'endereco' (decodificada agora se não estiver na cache)
+    const Linha& linha(std::uint32_t endereco);
+    // Sem decodificar: nullptr se não estiver na cache
+    const Linha* linhaEmCache(std::uint32_t endereco) const;
+
+    // Início da instrução que contém 'endereco', varrendo desde o começo da página
+    // (heurística: dados no meio do código podem desalinhar a varredura)
+    std::uint32_t inicioDaInstrucao(std::uint32_t endereco);
+    // Início da instrução anterior à que começa em 'endereco'
+    std::uint32_t anterior(std::uint32_t endereco);
+
+    // O byte em 'endereco' foi escrito
+    void invalidar(std::uint32_t endereco);
+    void invalidar(const std::vector<std::uint32_t>& enderecos);
+    void invalidarTudo();
+};
+
+#endif //VM_SIC_CACHEDESMONTAGEM_H
@@ -0,0 +1,170 @@
+#include "Decodificador.h"
+#include <array>
+#include <cstdio>
+
+/*
+=========================================================================================
+Tabela dos opcodes implementados pela máquina, indexada por opcode >> 2.
+0x04 é CLEAR (formato 2) nesta máquina; por isso não há LDX.
+=========================================================================================
+*/
+static constexpr std::array<InfoOpcode, 64> criarTabelaOpcodes() {
+    std::array<InfoOpcode, 64> t{};
+    auto def = [&t](std::uint8_t opcode, const char* mnemonico, Formato formato, Operandos operandos) {
+        t[opcode >> 2] = InfoOpcode{mnemonico, formato, operandos};
+    };
+    const Formato F1 = Formato::F1, F2 = Formato::F2, F3 = Formato::F3;
+    const Operandos M = Operandos::MEMORIA;
+
+    def(0x00, "LDA", F3, M);   def(0x08, "LDL", F3, M);   def(0x0C, "STA", F3, M);
+    def(0x10, "STX", F3, M);   def(0x14, "STL", F3, M);   def(0x18, "ADD", F3, M);
+    def(0x1C, "SUB", F3, M);   def(0x20, "MUL", F3, M);   def(0x24, "DIV", F3, M);
+    def(0x28, "COMP", F3, M);  def(0x2C, "TIX", F3, M);   def(0x30, "JEQ", F3, M);
+    def(0x34, "JGT", F3, M);   def(0x38, "JLT", F3, M);   def(0x3C, "J", F3, M);
+    def(0x40, "AND", F3, M);   def(0x44, "OR", F3, M);    def(0x48, "JSUB", F3, M);
+    def(0x50, "LDCH", F3, M);  def(0x54, "STCH", F3, M);  def(0x58, "ADDF", F3, M);
+    def(0x5C, "SUBF", F3, M);  def(0x60, "MULF", F3, M);  def(0x64, "DIVF", F3, M);
+    def(0x68, "LDB", F3, M);   def(0x6C, "LDS", F3, M);   def(0x70, "LDF", F3, M);
+    def(0x74, "LDT", F3, M);   def(0x78, "STB", F3, M);   def(0x7C, "STS", F3, M);
+    def(0x80, "STF", F3, M);   def(0x84, "STT", F3, M);   def(0x88, "COMPF", F3, M);
+    def(0xCC, "LPT", F3, M);   def(0xD0, "LPS", F3, M);   def(0xD4, "STI", F3, M);
+    def(0xD8, "RD", F3, M);    def(0xDC, "WD", F3, M);    def(0xE0, "TD", F3, M);
+
+    def(0x4C, "RSUB", F1, Operandos::NENHUM);
+    def(0xC0, "FLOAT", F1, Operandos::NENHUM);
+    def(0xC4, "FIX", F1, Operandos::NENHUM);
+    def(0xC8, "NORM", F1, Operandos::NENHUM);
+
+    def(0x04, "CLEAR", F2, Operandos::R1);     def(0x90, "ADDR", F2, Operandos::R1_R2);
+    def(0x94, "SUBR", F2, Operandos::R1_R2);   def(0x98, "MULR", F2, Operandos::R1_R2);
+    def(0x9C, "DIVR", F2, Operandos::R1_R2);   def(0xA0, "COMPR", F2, Operandos::R1_R2);
+    def(0xA4, "SHIFTL", F2, Operandos::R1_N);  def(0xA8, "SHIFTR", F2, Operandos::R1_N);
+    def(0xAC, "RMO", F2, Operandos::R1_R2);    def(0xB0, "SVC", F2, Operandos::N);
+    def(0xB8, "TIXR", F2, Operandos::R1);
+    def(0xBC, "IDCPU", F2, Operandos::R1);     // extensão desta máquina
+    def(0xE4, "HCALL", F2, Operandos::BYTE2);  // extensão desta máquina
+    return t;
+}
+
+static constexpr std::array<InfoOpcode, 64> TABELA_OPCODES = criarTabelaOpcodes();
+
+const InfoOpcode& infoOpcode(std::uint8_t opcode) {
+    return TABELA_OPCODES[opcode >> 2];
+}
+
+/*
+=========================================================================================
+Formato de cada opcode implementado pela máquina.
+=========================================================================================
+*/
+Formato formatoDoOpcode(std::uint8_t opcode) {
+    return TABELA_OPCODES[opcode >> 2].formato; // os não implementados ficam como 3 ou 4 (bit e)
+}
+
+/*
+=========================================================================================
+Separar os campos de uma instrução a partir dos seus bytes.
+=========================================================================================
+*/
+InstrucaoDecodificada decodificar(std::uint8_t byte1, std::uint8_t byte2, std::uint8_t byte3, std::uint8_t byte4) {
+    InstrucaoDecodificada inst;
+    inst.opcode = byte1 & 0xFC;
+    inst.formato = formatoDoOpcode(inst.opcode);
+
+    if (inst.formato == Formato::F1) {
+        inst.tamanho = 1;
+        return inst;
+    }
+
+    if (inst.formato == Formato::F2) {
+        inst.tamanho = 2;
+        inst.r1 = (byte2 >> 4) & 0x0F;
+        inst.r2 = byte2 & 0x0F;
+        return inst;
+    }
+
+    // Extrair ni do primeiro Byte
+    inst.n = (byte1 >> 1) & 1;
+    inst.i = byte1 & 1;
+
+    // Extrair xbpe do segundo Byte
+    inst.x = (byte2 >> 7) & 1;
+    inst.b = (byte2 >> 6) & 1;
+    inst.p = (byte2 >> 5) & 1;
+    inst.e = (byte2 >> 4) & 1;
+
+    if (inst.e) { // Formato 4
+        inst.formato = Formato::F4;
+        inst.tamanho = 4;
+        inst.disp = ((byte2 & 0x0F) << 16) | (byte3 << 8) | byte4;
+    } else { // Formato 3
+        inst.disp = ((byte2 & 0x0F) << 8) | byte3;
+        // Extensão de sinal para deslocamento de 12 bits (para PC e Base relative)
+        if (inst.disp & 0x800) {
+            inst.disp |= 0xFFFFF000;
+        }
+    }
+    return inst;
+}
+
+/*
+=========================================================================================
+Desmontar uma instrução já decodificada.
+=========================================================================================
+*/
+static const char* nomeRegistrador(std::uint8_t numero) {
+    static const char* const nomes[16] = {"A", "X", "L", "B", "S", "T", "F", "?7",
+                                          "PC", "SW", "?10", "?11", "?12", "?13", "?14", "?15"};
+    return nomes[numero & 0x0F];
+}
+
+std::string desmontar(const InstrucaoDecodificada& inst, std::uint32_t endereco) {
+    const InfoOpcode& info = infoOpcode(inst.opcode);
+    char texto[48];
+
+    if (!info.mnemonico) {
+        std::snprintf(texto, sizeof texto, "BYTE X'%02X'", inst.opcode | (inst.n << 1) | inst.i);
+        return texto;
+    }
+
+    switch (info.operandos) {
+        case Operandos::NENHUM:
+            return info.mnemonico;
+        case Operandos::R1:
+            std::snprintf(texto, sizeof texto, "%s %s", info.mnemonico, nomeRegistrador(inst.r1));
+            return texto;
+        case Operandos::R1_R2:
+            std::snprintf(texto, sizeof texto, "%s %s,%s", info.mnemonico, nomeRegistrador(inst.r1),
+                          nomeRegistrador(inst.r2));
+            return texto;
+        case Operandos::R1_N:
+            std::snprintf(texto, sizeof texto, "%s %s,%d", info.mnemonico, nomeRegistrador(inst.r1), inst.r2 + 1);
+            return texto;
+        case Operandos::N:
+            std::snprintf(texto, sizeof texto, "%s %d", info.mnemonico, inst.r1);
+            return texto;
+        case Operandos::BYTE2:
+            std::snprintf(texto, sizeof texto, "%s %d", info.mnemonico, (inst.r1 << 4) | inst.r2);
+            return texto;
+        case Operandos::MEMORIA:
+            break;
+    }
+
+    const char* prefixo = inst.formato == Formato::F4 ? "+" : "";
+    const char* modo = inst.i ? "#" : (inst.n ? "@" : "");
+    const char* indice = inst.x ? ",X" : "";
+    if (inst.formato == Formato::F4) {
+        std::snprintf(texto, sizeof texto, "%s%s %s0x%05X%s", prefixo, info.mnemonico, modo,
+                      static_cast<unsigned>(inst.disp), indice);
+    } else if (inst.p) {
+        const std::uint32_t alvo = (endereco + inst.tamanho + inst.disp) & 0xFFFFFF;
+        std::snprintf(texto, sizeof texto, "%s %s0x%04X%s", info.mnemonico, modo, alvo, indice);
+    } else if (inst.b) {
+        std::snprintf(texto, sizeof texto, "%s %sB%c0x%03X%s", info.mnemonico, modo, inst.disp < 0 ? '-' : '+',
+                      static_cast<unsigned>(inst.disp < 0 ? -inst.disp : inst.disp), indice);
+    } else {
+        std::snprintf(texto, sizeof texto, "%s %s0x%04X%s", info.mnemonico, modo,
+                      static_cast<unsigned>(inst.disp) & 0xFFFFFF, indice);
+    }
+    return texto;
+}
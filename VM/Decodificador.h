@@ -0,0 +1,48 @@
+#ifndef VM_SIC_DECODIFICADOR_H
+#define VM_SIC_DECODIFICADOR_H
+
+#include <cstdint>
+#include <string>
+
+enum class Formato : std::uint8_t { F1 = 1, F2 = 2, F3 = 3, F4 = 4 };
+
+// Campos de uma instrução já separados, na forma usada por Maquina::passo()
+struct InstrucaoDecodificada {
+    std::uint8_t opcode = 0;      // byte 1 sem os bits n/i
+    Formato formato = Formato::F3;
+    std::uint8_t tamanho = 3;     // em bytes
+    bool n = false, i = false, x = false, b = false, p = false, e = false;
+    std::uint8_t r1 = 0, r2 = 0;  // Formato 2
+    std::int32_t disp = 0;        // Formato 3 (com extensão de sinal) ou 4 (endereço de 20 bits)
+};
+
+// Operandos de cada instrução na forma do montador (para a desmontagem)
+enum class Operandos : std::uint8_t {
+    NENHUM,  // RSUB, FLOAT, FIX, NORM
+    MEMORIA, // formato 3/4: m (#imediato, @indireto, ,X)
+    R1,      // CLEAR r1, TIXR r1, IDCPU r1
+    R1_R2,   // ADDR r1,r2 ...
+    R1_N,    // SHIFTL/SHIFTR r1,n (n = r2 + 1)
+    N,       // SVC n (n = r1)
+    BYTE2    // HCALL n (n = segundo byte inteiro)
+};
+
+// Entrada da tabela de opcodes, única para a execução e para a desmontagem
+struct InfoOpcode {
+    const char* mnemonico = nullptr; // nullptr = opcode não implementado pela máquina
+    Formato formato = Formato::F3;
+    Operandos operandos = Operandos::MEMORIA;
+};
+
+const InfoOpcode& infoOpcode(std::uint8_t opcode);
+Formato formatoDoOpcode(std::uint8_t opcode);
+
+// Decodifica a partir dos 4 primeiros bytes da instrução (os excedentes são ignorados)
+InstrucaoDecodificada decodificar(std::uint8_t byte1, std::uint8_t byte2, std::uint8_t byte3, std::uint8_t byte4);
+
+// Texto da instrução no formato do montador ("+LDA #0x01000", "RMO A,X", "JLT 0x0006,X"),
+// com os alvos relativos ao PC já resolvidos a partir de 'endereco' (onde a instrução está).
+// O endereçamento segue passo(): i=1 é imediato mesmo com n=1.
+std::string desmontar(const InstrucaoDecodificada& inst, std::uint32_t endereco);
+
+#endif //VM_SIC_DECODIFICADOR_H
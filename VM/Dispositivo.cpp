@@ -0,0 +1,256 @@
+#include "Dispositivo.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <stdexcept>
+
+DispositivoArquivo::DispositivoArquivo(std::FILE* arquivo, bool fechar_ao_destruir)
+    : m_arquivo(arquivo), m_fechar(fechar_ao_destruir) {
+    m_saida.reserve(TAMANHO_BUFFER);
+}
+
+DispositivoArquivo::~DispositivoArquivo() {
+    descarregar();
+    if (m_fechar && m_arquivo) {
+        std::fclose(m_arquivo);
+    }
+}
+
+std::shared_ptr<DispositivoArquivo> DispositivoArquivo::abrir(const std::string& caminho, const char* modo) {
+    std::FILE* arquivo = std::fopen(caminho.c_str(), modo);
+    if (!arquivo) {
+        throw std::runtime_error("Erro ao abrir o dispositivo: " + caminho);
+    }
+    return std::make_shared<DispositivoArquivo>(arquivo, true);
+}
+
+// lê o próximo bloco inteiro de uma vez
+void DispositivoArquivo::recarregar() {
+    m_entrada.resize(TAMANHO_BUFFER);
+    std::size_t lidos = (m_arquivo && !m_fim) ? std::fread(m_entrada.data(), 1, TAMANHO_BUFFER, m_arquivo) : 0;
+    if (lidos == 0) {
+        m_fim = true;
+    }
+    m_entrada.resize(lidos);
+    m_pos = 0;
+}
+
+void DispositivoArquivo::descarregar() {
+    if (m_arquivo && !m_saida.empty()) {
+        std::fwrite(m_saida.data(), 1, m_saida.size(), m_arquivo);
+        std::fflush(m_arquivo);
+    }
+    m_saida.clear();
+}
+
+DispositivoMemoria::DispositivoMemoria(std::vector<std::uint8_t> entrada, bool fechada)
+    : m_entrada(std::move(entrada)), m_entrada_fechada(fechada) {}
+
+void DispositivoMemoria::adicionarEntrada(const std::vector<std::uint8_t>& bytes) {
+    {
+        std::lock_guard<std::mutex> trava(m_mtx);
+        m_entrada.insert(m_entrada.end(), bytes.begin(), bytes.end());
+    }
+    avisarPronto();
+}
+
+void DispositivoMemoria::fecharEntrada() {
+    {
+        std::lock_guard<std::mutex> trava(m_mtx);
+        m_entrada_fechada = true;
+    }
+    avisarPronto();
+}
+
+std::vector<std::uint8_t> DispositivoMemoria::getSaida() {
+    std::lock_guard<std::mutex> trava(m_mtx);
+    return m_saida;
+}
+
+bool DispositivoMemoria::pronto() {
+    std::lock_guard<std::mutex> trava(m_mtx);
+    return m_pos < m_entrada.size() || m_entrada_fechada;
+}
+
+bool DispositivoMemoria::ler(std::uint8_t& byte) {
+    std::lock_guard<std::mutex> trava(m_mtx);
+    if (m_pos < m_entrada.size()) {
+        byte = m_entrada[m_pos++];
+        return true;
+    }
+    if (m_entrada_fechada) {
+        byte = 0;
+        return true;
+    }
+    return false;
+}
+
+bool DispositivoMemoria::escrever(std::uint8_t byte) {
+    std::lock_guard<std::mutex> trava(m_mtx);
+    m_saida.push_back(byte);
+    return true;
+}
+
+AnelBytes::AnelBytes(std::size_t capacidade_potencia_de_2)
+    : m_dados(capacidade_potencia_de_2), m_mascara(capacidade_potencia_de_2 - 1) {}
+
+std::size_t AnelBytes::colocarBloco(const std::uint8_t* bytes, std::size_t n) {
+    std::size_t cauda = m_cauda.load(std::memory_order_relaxed);
+    std::size_t livre = m_dados.size() - (cauda - m_cabeca.load(std::memory_order_acquire));
+    n = std::min(n, livre);
+    for (std::size_t k = 0; k < n; ++k) {
+        m_dados[(cauda + k) & m_mascara] = bytes[k];
+    }
+    m_cauda.store(cauda + n, std::memory_order_release);
+    return n;
+}
+
+std::size_t AnelBytes::retirarBloco(std::uint8_t* bytes, std::size_t n) {
+    std::size_t cabeca = m_cabeca.load(std::memory_order_relaxed);
+    n = std::min(n, m_cauda.load(std::memory_order_acquire) - cabeca);
+    for (std::size_t k = 0; k < n; ++k) {
+        bytes[k] = m_dados[(cabeca + k) & m_mascara];
+    }
+    m_cabeca.store(cabeca + n, std::memory_order_release);
+    return n;
+}
+
+DispositivoAssincrono::DispositivoAssincrono(std::FILE* entrada, std::FILE* saida, bool fechar_ao_destruir)
+    : m_entrada(entrada), m_saida(saida), m_fechar(fechar_ao_destruir),
+      m_anel_entrada(CAPACIDADE_ANEL), m_anel_saida(CAPACIDADE_ANEL) {
+    if (::pipe(m_despertar) != 0) {
+        throw std::runtime_error("Erro ao criar o pipe do dispositivo assincrono.");
+    }
+    for (int fd : m_despertar) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    m_fim_entrada = (m_entrada == nullptr);
+    m_thread = std::thread([this] { laco(); });
+}
+
+DispositivoAssincrono::~DispositivoAssincrono() {
+    m_parar.store(true);
+    despertar(); // mesmo que ainda não esteja dormindo: o byte fica no pipe para o próximo poll
+    m_thread.join();
+    ::close(m_despertar[0]);
+    ::close(m_despertar[1]);
+
+    if (m_fechar) {
+        if (m_entrada) std::fclose(m_entrada);
+        if (m_saida) std::fclose(m_saida);
+    }
+}
+
+void DispositivoAssincrono::despertar() {
+    const std::uint8_t byte = 1;
+    [[maybe_unused]] ssize_t n = ::write(m_despertar[1], &byte, 1); // pipe cheio: já há aviso pendente
+}
+
+std::shared_ptr<DispositivoAssincrono> DispositivoAssincrono::abrirEntrada(const std::string& caminho) {
+    std::FILE* arquivo = std::fopen(caminho.c_str(), "rb");
+    if (!arquivo) {
+        throw std::runtime_error("Erro ao abrir o dispositivo: " + caminho);
+    }
+    return std::make_shared<DispositivoAssincrono>(arquivo, nullptr, true);
+}
+
+std::shared_ptr<DispositivoAssincrono> DispositivoAssincrono::abrirSaida(const std::string& caminho) {
+    std::FILE* arquivo = std::fopen(caminho.c_str(), "wb");
+    if (!arquivo) {
+        throw std::runtime_error("Erro ao abrir o dispositivo: " + caminho);
+    }
+    return std::make_shared<DispositivoAssincrono>(nullptr, arquivo, true);
+}
+
+/*
+=========================================================================================
+Lê o que já estiver disponível na entrada, até o espaço livre no anel: num pipe ou
+terminal, read(2) devolve o que chegou sem esperar um bloco inteiro. Zero bytes é o fim.
+=========================================================================================
+*/
+bool DispositivoAssincrono::lerEntrada(std::uint8_t* bloco) {
+    const int fd = ::fileno(m_entrada);
+    pollfd pronto{fd, POLLIN, 0};
+    if (::poll(&pronto, 1, 0) <= 0) {
+        return false;
+    }
+    const std::size_t livre = m_anel_entrada.capacidade() - m_anel_entrada.tamanho();
+    const ssize_t n = ::read(fd, bloco, std::min(livre, TAMANHO_BLOCO));
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+        return false;
+    }
+    if (n > 0) {
+        m_anel_entrada.colocarBloco(bloco, static_cast<std::size_t>(n));
+    } else {
+        m_fim_entrada.store(true, std::memory_order_release); // fim ou erro de leitura
+    }
+    avisarPronto();
+    return true;
+}
+
+/*
+=========================================================================================
+Laço da thread de E/S: grava o que houver no anel de saída e completa o anel de
+entrada com o que estiver disponível. Sem nada a fazer, dorme em poll (sem prazo) no
+pipe de despertar e, se há espaço no anel de entrada, também no arquivo de entrada.
+=========================================================================================
+*/
+void DispositivoAssincrono::laco() {
+    std::vector<std::uint8_t> bloco(TAMANHO_BLOCO);
+    bool gravou = false;
+
+    auto quer_entrada = [this] {
+        return m_entrada && !m_fim_entrada.load(std::memory_order_relaxed) && !m_parar.load() &&
+               m_anel_entrada.tamanho() < m_anel_entrada.capacidade();
+    };
+    auto tem_saida = [&] {
+        return m_saida && (m_anel_saida.tamanho() > 0 ||
+                           (gravou && m_pedido_descarga.load(std::memory_order_relaxed)));
+    };
+
+    while (true) {
+        bool trabalhou = false;
+
+        if (m_saida) {
+            std::size_t n = m_anel_saida.retirarBloco(bloco.data(), bloco.size());
+            if (n > 0) {
+                std::fwrite(bloco.data(), 1, n, m_saida);
+                gravou = trabalhou = true;
+                avisarPronto(); // há espaço de novo para WD
+            } else if (gravou && m_pedido_descarga.exchange(false, std::memory_order_relaxed)) {
+                std::fflush(m_saida);
+                gravou = false;
+            }
+        }
+
+        if (quer_entrada() && lerEntrada(bloco.data())) {
+            trabalhou = true;
+        }
+
+        if (trabalhou) {
+            continue;
+        }
+        if (m_parar.load()) {
+            break; // anel de saída já vazio
+        }
+
+        m_dormindo.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const bool esperar_entrada = quer_entrada();
+        if (!tem_saida() && !m_parar.load()) {
+            pollfd fds[2] = {{m_despertar[0], POLLIN, 0}, {esperar_entrada ? ::fileno(m_entrada) : -1, POLLIN, 0}};
+            ::poll(fds, esperar_entrada ? 2 : 1, -1);
+        }
+        m_dormindo.store(false, std::memory_order_relaxed);
+
+        std::uint8_t descarte[64];
+        while (::read(m_despertar[0], descarte, sizeof descarte) > 0) {}
+    }
+
+    if (m_saida) {
+        std::fflush(m_saida);
+    }
+}
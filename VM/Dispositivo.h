@@ -0,0 +1,233 @@
+#ifndef VM_SIC_DISPOSITIVO_H
+#define VM_SIC_DISPOSITIVO_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Dispositivo de E/S usado por RD, WD e TD. ler()/escrever() retornam false quando o
+// dispositivo não está pronto; a máquina então para sem executar a instrução.
+class Dispositivo {
+public:
+    virtual ~Dispositivo() = default;
+
+    virtual bool pronto() = 0;                    // TD
+    virtual bool ler(std::uint8_t& byte) = 0;     // RD
+    virtual bool escrever(std::uint8_t byte) = 0; // WD
+    virtual void descarregar() {}                 // envia o que estiver no buffer de saída
+
+    // Para quem espera o dispositivo ficar pronto sem consultá-lo em laço
+    // (EscalonadorCooperativo): 'aviso' é chamado, da thread que mudou o estado, quando
+    // o dispositivo pode ter ficado pronto. nullptr desliga; depois de desligado, nenhum
+    // aviso em andamento continua usando o anterior.
+    void setAvisoPronto(std::function<void()> aviso) {
+        std::lock_guard<std::mutex> trava(m_mtx_aviso);
+        m_aviso_pronto = std::move(aviso);
+    }
+
+protected:
+    void avisarPronto() {
+        std::lock_guard<std::mutex> trava(m_mtx_aviso);
+        if (m_aviso_pronto) m_aviso_pronto();
+    }
+
+private:
+    std::mutex m_mtx_aviso;
+    std::function<void()> m_aviso_pronto;
+};
+
+// Arquivo, pipe ou entrada/saída padrão. A leitura é feita em blocos e a escrita é
+// acumulada e enviada em blocos, nunca um byte por chamada ao sistema. No fim da
+// entrada RD lê X'00'. Use um dispositivo para entrada e outro para saída.
+class DispositivoArquivo : public Dispositivo {
+private:
+    static constexpr std::size_t TAMANHO_BUFFER = 64 * 1024;
+
+    std::FILE* m_arquivo;
+    bool m_fechar;
+    std::vector<std::uint8_t> m_entrada;
+    std::size_t m_pos = 0;
+    bool m_fim = false;
+    std::vector<std::uint8_t> m_saida;
+
+    void recarregar();
+
+public:
+    DispositivoArquivo(std::FILE* arquivo, bool fechar_ao_destruir);
+    ~DispositivoArquivo() override;
+
+    // modo como em fopen ("rb", "wb", "ab")
+    static std::shared_ptr<DispositivoArquivo> abrir(const std::string& caminho, const char* modo);
+
+    bool pronto() override { return true; } // a leitura espera pelo arquivo/pipe
+
+    bool ler(std::uint8_t& byte) override {
+        if (m_pos == m_entrada.size()) {
+            recarregar();
+        }
+        byte = m_pos < m_entrada.size() ? m_entrada[m_pos++] : 0;
+        return true;
+    }
+
+    bool escrever(std::uint8_t byte) override {
+        m_saida.push_back(byte);
+        if (m_saida.size() >= TAMANHO_BUFFER) {
+            descarregar();
+        }
+        return true;
+    }
+
+    void descarregar() override;
+};
+
+// Dispositivo em memória. Criado com a entrada aberta (fechada = false), ela pode ser
+// alimentada por outra thread enquanto o convidado roda: vazia, o dispositivo não está
+// pronto até chegar mais entrada ou fecharEntrada() indicar o fim (daí RD lê X'00').
+class DispositivoMemoria : public Dispositivo {
+private:
+    std::mutex m_mtx;
+    std::vector<std::uint8_t> m_entrada;
+    std::size_t m_pos = 0;
+    bool m_entrada_fechada = true; // sem entrada: só saída
+    std::vector<std::uint8_t> m_saida;
+
+public:
+    DispositivoMemoria() = default;
+    explicit DispositivoMemoria(std::vector<std::uint8_t> entrada, bool fechada = true);
+
+    void adicionarEntrada(const std::vector<std::uint8_t>& bytes);
+    void fecharEntrada();
+    std::vector<std::uint8_t> getSaida();
+
+    bool pronto() override;
+    bool ler(std::uint8_t& byte) override;
+    bool escrever(std::uint8_t byte) override;
+};
+
+// Fila circular de bytes com um produtor e um consumidor, sem travas
+class AnelBytes {
+private:
+    std::vector<std::uint8_t> m_dados;
+    std::size_t m_mascara;
+    alignas(64) std::atomic<std::size_t> m_cabeca{0}; // próximo a ser lido (consumidor)
+    alignas(64) std::atomic<std::size_t> m_cauda{0};  // próximo a ser escrito (produtor)
+
+public:
+    explicit AnelBytes(std::size_t capacidade_potencia_de_2);
+
+    std::size_t capacidade() const { return m_dados.size(); }
+    std::size_t tamanho() const {
+        return m_cauda.load(std::memory_order_acquire) - m_cabeca.load(std::memory_order_acquire);
+    }
+
+    bool colocar(std::uint8_t byte) {
+        std::size_t cauda = m_cauda.load(std::memory_order_relaxed);
+        if (cauda - m_cabeca.load(std::memory_order_acquire) == m_dados.size()) {
+            return false;
+        }
+        m_dados[cauda & m_mascara] = byte;
+        m_cauda.store(cauda + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool retirar(std::uint8_t& byte) {
+        std::size_t cabeca = m_cabeca.load(std::memory_order_relaxed);
+        if (cabeca == m_cauda.load(std::memory_order_acquire)) {
+            return false;
+        }
+        byte = m_dados[cabeca & m_mascara];
+        m_cabeca.store(cabeca + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t colocarBloco(const std::uint8_t* bytes, std::size_t n);
+    std::size_t retirarBloco(std::uint8_t* bytes, std::size_t n);
+};
+
+// Arquivo, pipe ou terminal atendido por uma thread de E/S própria: a entrada é lida
+// antecipadamente para um anel e as escritas vão para outro anel que a thread esvazia
+// depois (write-behind). RD/WD nunca esperam pelo sistema: com o anel vazio (ou cheio)
+// o dispositivo simplesmente não está pronto. No fim da entrada RD lê X'00'.
+// A entrada é lida direto do descritor (read(2), sem o buffer do FILE), só quando poll(2)
+// diz que há dados, e cada byte que chega vai logo para o anel. Sem nada a fazer, a
+// thread dorme em poll até chegar entrada ou o convidado acordá-la (pipe de despertar).
+// Qualquer um dos dois arquivos pode ser nulo; o destrutor espera a saída ser gravada.
+class DispositivoAssincrono : public Dispositivo {
+private:
+    static constexpr std::size_t CAPACIDADE_ANEL = 256 * 1024;
+    static constexpr std::size_t TAMANHO_BLOCO = 64 * 1024;
+
+    std::FILE* m_entrada;
+    std::FILE* m_saida;
+    bool m_fechar;
+
+    AnelBytes m_anel_entrada;
+    AnelBytes m_anel_saida;
+    std::atomic<bool> m_fim_entrada{false};
+    std::atomic<bool> m_pedido_descarga{false};
+    std::atomic<bool> m_parar{false};
+
+    // A thread de E/S só é acordada se estiver dormindo, e não a cada byte. Ela anuncia
+    // m_dormindo e só então olha os anéis; quem mexe num anel olha m_dormindo depois.
+    // As barreiras dos dois lados garantem que ao menos um vê o outro.
+    std::atomic<bool> m_dormindo{false};
+    int m_despertar[2] = {-1, -1}; // pipe: um byte em [1] tira a thread do poll
+    std::thread m_thread;
+
+    void acordar() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_dormindo.load(std::memory_order_relaxed) && m_dormindo.exchange(false, std::memory_order_relaxed)) {
+            despertar();
+        }
+    }
+    void despertar();
+    bool lerEntrada(std::uint8_t* bloco); // false se não havia nada a ler agora
+    void laco();
+
+public:
+    DispositivoAssincrono(std::FILE* entrada, std::FILE* saida, bool fechar_ao_destruir);
+    ~DispositivoAssincrono() override;
+
+    static std::shared_ptr<DispositivoAssincrono> abrirEntrada(const std::string& caminho);
+    static std::shared_ptr<DispositivoAssincrono> abrirSaida(const std::string& caminho);
+
+    bool pronto() override {
+        bool entrada_ok = !m_entrada || m_anel_entrada.tamanho() > 0 || m_fim_entrada.load(std::memory_order_acquire);
+        bool saida_ok = !m_saida || m_anel_saida.tamanho() < m_anel_saida.capacidade();
+        return entrada_ok && saida_ok;
+    }
+
+    bool ler(std::uint8_t& byte) override {
+        if (m_anel_entrada.retirar(byte)) {
+            acordar();
+            return true;
+        }
+        // o fim só vale depois de esvaziar o anel: o último bloco pode ter chegado junto com ele
+        if (m_fim_entrada.load(std::memory_order_acquire)) {
+            if (!m_anel_entrada.retirar(byte)) byte = 0;
+            return true;
+        }
+        acordar();
+        return false;
+    }
+
+    bool escrever(std::uint8_t byte) override {
+        bool ok = m_anel_saida.colocar(byte);
+        acordar();
+        return ok;
+    }
+
+    // Só pede à thread de E/S que grave o que estiver pendente; não espera
+    void descarregar() override {
+        m_pedido_descarga.store(true, std::memory_order_relaxed);
+        acordar();
+    }
+};
+
+#endif //VM_SIC_DISPOSITIVO_H
@@ -0,0 +1,158 @@
+#include "EscalonadorCooperativo.h"
+#include <algorithm>
+#include <utility>
+
+EscalonadorCooperativo::EscalonadorCooperativo(unsigned num_threads, std::uint64_t quantum)
+    : m_num_threads(std::max(1u, num_threads)), m_quantum(std::max<std::uint64_t>(1, quantum)) {}
+
+EscalonadorCooperativo::~EscalonadorCooperativo() {
+    for (const auto& d : m_observados) d->setAvisoPronto(nullptr);
+    for (Handle h : m_prontos) h.destroy();
+    for (Handle h : m_bloqueados) h.destroy();
+}
+
+/*
+=========================================================================================
+Corpo padrão de um convidado: executa um quantum e cede a vez, até a máquina parar.
+Bloqueado em RD/WD, o convidado só volta à fila quando o dispositivo avisar que ficou
+pronto. O aviso é ligado antes do teste do co_await, então não se perde. Com eventos na
+agenda (ex.: o temporizador do STI) a máquina nem chega a bloquear: executar() salta o
+tempo ocioso até o próximo evento e segue.
+=========================================================================================
+*/
+TarefaConvidado EscalonadorCooperativo::rodar(Maquina& vm) {
+    while (true) {
+        Falha falha = vm.executar(m_quantum);
+        if (falha == Falha::LIMITE_INSTRUCOES) {
+            co_await std::suspend_always{};
+        } else if (falha == Falha::AGUARDANDO_DISPOSITIVO) {
+            std::shared_ptr<Dispositivo> d = vm.getDispositivo(vm.getDispositivoAguardado());
+            observar(d);
+            Aguardar espera{[d] { return d->pronto(); }}; // nomeado: temporários em co_await confundem o GCC 12
+            co_await espera;
+        } else {
+            break;
+        }
+    }
+}
+
+void EscalonadorCooperativo::observar(const std::shared_ptr<Dispositivo>& dispositivo) {
+    {
+        std::lock_guard<std::mutex> trava(m_mtx);
+        if (std::find(m_observados.begin(), m_observados.end(), dispositivo) != m_observados.end()) {
+            return;
+        }
+        m_observados.push_back(dispositivo);
+    }
+    dispositivo->setAvisoPronto([this] { notificar(); });
+}
+
+void EscalonadorCooperativo::adicionar(Maquina& vm) {
+    vm.setEsperaNoHost(false); // quem espera é a corrotina, não a thread
+    adicionar(rodar(vm));
+}
+
+void EscalonadorCooperativo::adicionar(TarefaConvidado tarefa) {
+    {
+        std::lock_guard<std::mutex> trava(m_mtx);
+        m_prontos.push_back(tarefa.handle);
+        ++m_vivos;
+    }
+    m_cv.notify_one();
+}
+
+void EscalonadorCooperativo::notificar() {
+    {
+        std::lock_guard<std::mutex> trava(m_mtx);
+        m_reavaliar = true;
+        ++m_avisos;
+    }
+    m_cv.notify_one();
+}
+
+// Tira a lista de bloqueados da estrutura compartilhada e testa as condições sem a
+// trava: um pronto() lento (ou que trava o dispositivo) não segura as outras threads.
+// Um notificar() durante o teste deixa m_reavaliar ligado para a próxima rodada.
+void EscalonadorCooperativo::reavaliarBloqueados(std::unique_lock<std::mutex>& trava) {
+    m_reavaliar = false;
+    std::vector<Handle> avaliados;
+    avaliados.swap(m_bloqueados);
+
+    trava.unlock();
+    auto prontos = std::partition(avaliados.begin(), avaliados.end(),
+                                  [](Handle h) { return !h.promise().pronto(); });
+    trava.lock();
+
+    m_bloqueados.insert(m_bloqueados.end(), avaliados.begin(), prontos);
+    for (auto it = prontos; it != avaliados.end(); ++it) {
+        it->promise().pronto = nullptr;
+        m_prontos.push_back(*it);
+    }
+    if (prontos != avaliados.end()) {
+        m_cv.notify_all();
+    }
+}
+
+/*
+=========================================================================================
+Laço de cada thread: a cada rodada, reavalia os bloqueados se houve aviso e retoma um
+convidado pronto. Sem prontos e sem aviso, dorme até notificar() ou até outro convidado
+entrar na fila.
+=========================================================================================
+*/
+void EscalonadorCooperativo::trabalhador() {
+    std::unique_lock<std::mutex> trava(m_mtx);
+    while (m_vivos > 0) {
+        if (m_reavaliar && !m_bloqueados.empty()) {
+            reavaliarBloqueados(trava);
+            continue;
+        }
+        if (m_prontos.empty()) {
+            m_cv.wait(trava);
+            continue;
+        }
+
+        Handle h = m_prontos.front();
+        m_prontos.pop_front();
+        const std::uint64_t avisos = m_avisos;
+
+        trava.unlock();
+        h.resume();
+        trava.lock();
+
+        if (h.done()) {
+            if (h.promise().excecao && !m_excecao) {
+                m_excecao = h.promise().excecao;
+            }
+            h.destroy();
+            if (--m_vivos == 0) {
+                m_cv.notify_all();
+            }
+        } else if (h.promise().pronto) {
+            m_bloqueados.push_back(h);
+            if (m_avisos != avisos) {
+                // o aviso chegou enquanto o convidado rodava e pode ter sido consumido
+                // por uma reavaliação que ainda não o via bloqueado
+                m_reavaliar = true;
+            }
+        } else {
+            m_prontos.push_back(h);
+            m_cv.notify_one();
+        }
+    }
+}
+
+void EscalonadorCooperativo::executarTodos() {
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(m_num_threads);
+        for (unsigned i = 0; i < m_num_threads; ++i) {
+            threads.emplace_back([this] { trabalhador(); });
+        }
+    } // jthread faz join ao sair do escopo
+
+    if (m_excecao) {
+        std::exception_ptr excecao = std::exchange(m_excecao, nullptr);
+        std::rethrow_exception(excecao);
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef VM_SIC_ESCALONADORCOOPERATIVO_H
+#define VM_SIC_ESCALONADORCOOPERATIVO_H
+
+#include "Maquina_melhor.h"
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Corrotina de um convidado. A função de espera, quando definida, diz ao escalonador
+// que o convidado está bloqueado até ela retornar true.
+struct TarefaConvidado {
+    struct promise_type {
+        std::function<bool()> pronto;
+        std::exception_ptr excecao;
+
+        TarefaConvidado get_return_object() {
+            return TarefaConvidado{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { excecao = std::current_exception(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// co_await Aguardar{condicao}: suspende o convidado até a condição ser verdadeira
+struct Aguardar {
+    std::function<bool()> pronto;
+
+    bool await_ready() const { return pronto(); }
+    void await_suspend(std::coroutine_handle<TarefaConvidado::promise_type> h) { h.promise().pronto = std::move(pronto); }
+    void await_resume() const noexcept {}
+};
+
+// Multiplexa muitos convidados (uma Maquina cada) sobre poucas threads. Cada convidado
+// roda 'quantum' instruções e cede a vez; convidados bloqueados (ex.: RD em dispositivo
+// sem dados) ficam fora da fila de prontos até a condição de espera ser satisfeita.
+// Ninguém consulta os bloqueados em laço: depois de um notificar(), a próxima rodada de
+// uma thread reavalia as condições (fora da trava global) e devolve à fila quem puder andar.
+class EscalonadorCooperativo {
+private:
+    using Handle = std::coroutine_handle<TarefaConvidado::promise_type>;
+
+    unsigned m_num_threads;
+    std::uint64_t m_quantum;
+
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::deque<Handle> m_prontos;
+    std::vector<Handle> m_bloqueados;
+    bool m_reavaliar = false; // houve notificar() desde a última reavaliação dos bloqueados
+    std::uint64_t m_avisos = 0; // notificar() já chamados
+    std::size_t m_vivos = 0;
+    std::exception_ptr m_excecao;
+    std::vector<std::shared_ptr<Dispositivo>> m_observados; // avisam notificar() ao ficar prontos
+
+    TarefaConvidado rodar(Maquina& vm);
+    void observar(const std::shared_ptr<Dispositivo>& dispositivo);
+    void trabalhador();
+    void reavaliarBloqueados(std::unique_lock<std::mutex>& trava); // chamada com m_mtx travado
+
+public:
+    explicit EscalonadorCooperativo(unsigned num_threads = std::thread::hardware_concurrency(),
+                                    std::uint64_t quantum = 10000);
+    ~EscalonadorCooperativo();
+
+    // A Maquina deve continuar viva até executarTodos() retornar
+    void adicionar(Maquina& vm);
+
+    // Adiciona um convidado com corpo próprio (ex.: laços de E/S escritos como corrotina).
+    // Quem muda a condição de um Aguardar deve chamar notificar() depois.
+    void adicionar(TarefaConvidado tarefa);
+
+    // A condição de algum convidado bloqueado pode ter mudado. Os dispositivos em que
+    // convidados Maquina esperam chamam sozinhos (Dispositivo::setAvisoPronto).
+    void notificar();
+
+    // Roda até todos os convidados terminarem; repassa a primeira exceção de um convidado
+    void executarTodos();
+
+    std::uint64_t getQuantum() const { return m_quantum; }
+};
+
+#endif //VM_SIC_ESCALONADORCOOPERATIVO_H
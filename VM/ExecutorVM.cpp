@@ -0,0 +1,67 @@
+#include "ExecutorVM.h"
+#include <algorithm>
+
+ExecutorVM::ExecutorVM(Maquina& vm, QObject *parent)
+    : QObject(parent), m_vm(vm)
+{
+    for (auto& pc : m_pcs_codigo) {
+        pc.store(InstantaneoVM::SEM_PC, std::memory_order_relaxed);
+    }
+}
+
+void ExecutorVM::setJanela(std::uint32_t inicio, std::uint32_t bytes)
+{
+    bytes = std::min<std::uint32_t>(bytes, InstantaneoVM::JANELA_MAX_BYTES);
+    m_janela.store((std::uint64_t{inicio} << 32) | bytes, std::memory_order_relaxed);
+}
+
+void ExecutorVM::setPCsCodigo(const std::vector<std::uint32_t>& pcs)
+{
+    for (std::size_t k = 0; k < m_pcs_codigo.size(); ++k) {
+        m_pcs_codigo[k].store(k < pcs.size() ? pcs[k] : InstantaneoVM::SEM_PC, std::memory_order_relaxed);
+    }
+}
+
+/*
+=========================================================================================
+Executa até a máquina parar por conta própria ou por solicitarParada(). Quem agenda
+este slot descarta antes um pedido de parada antigo (Maquina::descartarPedidoParada).
+O log de instruções fica desligado durante a execução: a GUI acompanha pelos
+instantâneos, e com log a máquina formata cada instrução e não acelera laços.
+=========================================================================================
+*/
+void ExecutorVM::executar()
+{
+    std::ostream* log = m_vm.getLog();
+    m_vm.setLog(nullptr);
+
+    const std::uint64_t inicio = m_vm.getContadorInstrucoes();
+    Falha falha;
+    do {
+        falha = m_vm.executar(INSTRUCOES_POR_FATIA);
+        publicar(m_vm.getContadorInstrucoes() - inicio);
+    } while (falha == Falha::LIMITE_INSTRUCOES);
+
+    m_vm.setLog(log);
+
+    emit terminou(static_cast<int>(falha), QString::fromStdString(m_vm.getErro()));
+}
+
+void ExecutorVM::publicar(std::uint64_t instrucoes)
+{
+    const std::uint64_t janela = m_janela.load(std::memory_order_relaxed);
+
+    InstantaneoVM& inst = m_instantaneos.escrita();
+    inst.r = m_vm.getCPU().r;
+    inst.instrucoes = instrucoes;
+    inst.inicio_janela = static_cast<std::uint32_t>(janela >> 32);
+    inst.bytes_janela = static_cast<std::uint32_t>(janela);
+    m_vm.getMemoria().copiarBytes(inst.inicio_janela, inst.bytes_janela, inst.janela.data());
+    for (std::size_t k = 0; k < m_pcs_codigo.size(); ++k) {
+        inst.pcs_codigo[k] = m_pcs_codigo[k].load(std::memory_order_relaxed);
+        if (inst.pcs_codigo[k] != InstantaneoVM::SEM_PC) {
+            m_vm.getMemoria().copiarBytes(inst.pcs_codigo[k], 4, inst.codigo[k].data());
+        }
+    }
+    m_instantaneos.publicar();
+}
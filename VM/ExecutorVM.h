@@ -0,0 +1,66 @@
+#ifndef VM_SIC_EXECUTORVM_H
+#define VM_SIC_EXECUTORVM_H
+
+#include <QObject>
+#include <QString>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "BufferTriplo.h"
+#include "Maquina_melhor.h"
+
+// Estado da máquina copiado entre duas fatias de execução, para a GUI mostrar
+// enquanto a máquina roda: registradores e a janela de memória visível na tabela.
+struct InstantaneoVM {
+    static constexpr std::size_t JANELA_MAX_BYTES = 3 * 512;
+    static constexpr std::size_t PCS_CODIGO = 10;             // instruções copiadas para desmontar
+    static constexpr std::uint32_t SEM_PC = 0xFFFFFFFF;
+
+    Registradores r;
+    std::uint64_t instrucoes = 0;   // desde o início desta execução
+    std::uint32_t inicio_janela = 0;
+    std::uint32_t bytes_janela = 0;
+    std::array<std::uint8_t, JANELA_MAX_BYTES> janela{};
+    // Os 4 primeiros bytes em cada endereço pedido por setPCsCodigo (SEM_PC = vazio)
+    std::array<std::uint32_t, PCS_CODIGO> pcs_codigo{};
+    std::array<std::array<std::uint8_t, 4>, PCS_CODIGO> codigo{};
+};
+
+// Executa a máquina fora da thread da GUI. Vive numa QThread própria (moveToThread);
+// executar() roda em fatias de INSTRUCOES_POR_FATIA instruções e, entre elas, publica
+// um InstantaneoVM. A publicação nunca espera a GUI, que lê instantaneos() no seu ritmo.
+// Para parar, a GUI chama Maquina::solicitarParada() diretamente.
+class ExecutorVM : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr std::uint64_t INSTRUCOES_POR_FATIA = std::uint64_t{1} << 16;
+
+    explicit ExecutorVM(Maquina& vm, QObject *parent = nullptr);
+
+    // Thread da GUI: trecho de memória a copiar nos próximos instantâneos
+    void setJanela(std::uint32_t inicio, std::uint32_t bytes);
+    // Thread da GUI: endereços cujas instruções vão nos próximos instantâneos (até PCS_CODIGO)
+    void setPCsCodigo(const std::vector<std::uint32_t>& pcs);
+    // Thread da GUI: lado consumidor do buffer
+    BufferTriplo<InstantaneoVM>& instantaneos() { return m_instantaneos; }
+
+public slots:
+    void executar();
+
+signals:
+    // 'falha' é um Falha convertido para int; 'erro' é Maquina::getErro()
+    void terminou(int falha, QString erro);
+
+private:
+    Maquina& m_vm;
+    BufferTriplo<InstantaneoVM> m_instantaneos;
+    std::atomic<std::uint64_t> m_janela{0}; // início << 32 | bytes, lidos juntos
+    std::array<std::atomic<std::uint32_t>, InstantaneoVM::PCS_CODIGO> m_pcs_codigo;
+
+    void publicar(std::uint64_t instrucoes);
+};
+
+#endif //VM_SIC_EXECUTORVM_H
@@ -0,0 +1,260 @@
+#include "HistoricoExecucao.h"
+#include <algorithm>
+#include <cstring>
+
+static std::uint32_t empacotarStatus(const Registradores& r) {
+    return static_cast<std::uint32_t>(r.SW + 1) | (r.modo << 8) | (r.mascara << 16) |
+           (static_cast<std::uint32_t>(r.icode) << 24);
+}
+
+static void desempacotarStatus(Registradores& r, std::uint32_t palavra) {
+    r.SW = static_cast<status>(static_cast<int>(palavra & 0xFF) - 1);
+    r.modo = (palavra >> 8) & 0xFF;
+    r.mascara = (palavra >> 16) & 0xFF;
+    r.icode = (palavra >> 24) & 0xFF;
+}
+
+static std::uint64_t bitsDe(double valor) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &valor, sizeof bits);
+    return bits;
+}
+
+HistoricoExecucao::HistoricoExecucao(std::size_t tamanho_memoria_bytes, std::size_t palavras)
+    : m_tamanho_memoria(tamanho_memoria_bytes) {
+    std::size_t capacidade = 1;
+    while (capacidade < palavras) {
+        capacidade <<= 1;
+    }
+    m_anel.resize(capacidade);
+    m_mascara_anel = capacidade - 1;
+}
+
+std::size_t HistoricoExecucao::palavrasRegistradores(std::uint32_t mascara) {
+    std::size_t n = 0;
+    for (std::uint32_t bit = ALTEROU_A; bit <= ALTEROU_STATUS; bit <<= 1) {
+        n += (mascara & bit) ? 1 : 0;
+    }
+    n += (mascara & ALTEROU_F) ? 2 : 0;
+    n += (mascara & INSTRUCOES_DIFERENTE) ? 2 : 0;
+    return n;
+}
+
+void HistoricoExecucao::limpar() {
+    m_inicio = m_fim = 0;
+    m_passos = 0;
+    m_total = 0;
+    m_pontos.clear();
+    m_marcos.clear();
+}
+
+/*
+=========================================================================================
+Fecha o passo: compara os registradores com os do início e grava a entrada. Um passo que
+não mudou nada (PC fora dos limites) não gera entrada.
+=========================================================================================
+*/
+void HistoricoExecucao::concluirPasso(const Registradores& r, std::uint64_t instrucoes, Memoria& memoria) {
+    memoria.setDiarioDesfazer(nullptr);
+
+    std::uint32_t mascara = 0;
+    std::uint32_t regs[13];
+    std::size_t nr = 0;
+    auto anotar = [&](std::int32_t agora, std::int32_t antes, std::uint32_t bit) {
+        if (agora != antes) {
+            mascara |= bit;
+            regs[nr++] = static_cast<std::uint32_t>(antes);
+        }
+    };
+    anotar(r.A, m_antes.A, ALTEROU_A);
+    anotar(r.X, m_antes.X, ALTEROU_X);
+    anotar(r.L, m_antes.L, ALTEROU_L);
+    anotar(r.B, m_antes.B, ALTEROU_B);
+    anotar(r.S, m_antes.S, ALTEROU_S);
+    anotar(r.T, m_antes.T, ALTEROU_T);
+    anotar(r.PC, m_antes.PC, ALTEROU_PC);
+    if (empacotarStatus(r) != empacotarStatus(m_antes)) {
+        mascara |= ALTEROU_STATUS;
+        regs[nr++] = empacotarStatus(m_antes);
+    }
+    if (bitsDe(r.F) != bitsDe(m_antes.F)) {
+        const std::uint64_t bits = bitsDe(m_antes.F);
+        mascara |= ALTEROU_F;
+        regs[nr++] = static_cast<std::uint32_t>(bits);
+        regs[nr++] = static_cast<std::uint32_t>(bits >> 32);
+    }
+    const std::uint64_t contadas = instrucoes - m_instrucoes_antes;
+    if (contadas != 1) {
+        if (contadas == 0 && mascara == 0 && m_diario.empty()) {
+            return;
+        }
+        mascara |= INSTRUCOES_DIFERENTE;
+        regs[nr++] = static_cast<std::uint32_t>(contadas);
+        regs[nr++] = static_cast<std::uint32_t>(contadas >> 32);
+    }
+
+    const std::size_t tamanho = 2 + m_diario.size() + nr;
+    if (m_diario.size() > MAX_BYTES_ENTRADA || tamanho > m_anel.size()) {
+        limpar(); // não cabe: daqui para trás não dá mais para voltar
+        return;
+    }
+    if (m_fim + tamanho - m_inicio > m_anel.size()) {
+        liberarEspaco(std::max(tamanho, m_anel.size() / FRACAO_DESCARTE));
+    }
+    if (m_total % PASSOS_POR_MARCO == 0) {
+        m_marcos.push_back(Marco{m_total, m_fim});
+    }
+
+    const std::uint32_t cabecalho = mascara | static_cast<std::uint32_t>(m_diario.size() << BITS_MASCARA);
+    if ((m_fim & m_mascara_anel) + tamanho <= m_anel.size()) { // sem dar a volta no anel
+        std::uint32_t* p = &palavra(m_fim);
+        *p++ = cabecalho;
+        p = std::copy(m_diario.begin(), m_diario.end(), p);
+        p = std::copy(regs, regs + nr, p);
+        *p = cabecalho;
+        m_fim += tamanho;
+    } else {
+        palavra(m_fim++) = cabecalho;
+        for (std::uint32_t anotado : m_diario) {
+            palavra(m_fim++) = anotado;
+        }
+        for (std::size_t k = 0; k < nr; ++k) {
+            palavra(m_fim++) = regs[k];
+        }
+        palavra(m_fim++) = cabecalho;
+    }
+    ++m_passos;
+    ++m_total;
+
+    const std::uint64_t ultimo_ponto = m_pontos.empty() ? 0 : m_pontos.back().passo;
+    if (m_total - ultimo_ponto >= INTERVALO_PONTOS) {
+        criarPonto(r, instrucoes, memoria);
+    }
+}
+
+/*
+=========================================================================================
+Anel cheio: descarta as entradas mais antigas até sobrarem 'palavras' livres. Pula de
+marco em marco enquanto possível; o resto sai entrada por entrada.
+=========================================================================================
+*/
+void HistoricoExecucao::liberarEspaco(std::size_t palavras) {
+    auto falta = [&] { return m_fim + palavras - m_inicio > m_anel.size(); };
+    while (falta() && !m_marcos.empty()) {
+        const Marco marco = m_marcos.front();
+        m_marcos.pop_front();
+        if (marco.posicao > m_inicio) {
+            m_passos = m_total - marco.passo;
+            m_inicio = marco.posicao;
+        }
+    }
+    while (falta() && m_passos > 0) {
+        descartarMaisAntiga();
+    }
+    descartarPontosAntigos();
+}
+
+void HistoricoExecucao::descartarMaisAntiga() {
+    const std::uint32_t cabecalho = palavra(m_inicio);
+    m_inicio += 2 + (cabecalho >> BITS_MASCARA) + palavrasRegistradores(cabecalho);
+    --m_passos;
+}
+
+// Pontos anteriores ao passo mais antigo que ainda pode ser desfeito não servem mais
+void HistoricoExecucao::descartarPontosAntigos() {
+    const std::uint64_t mais_antigo = m_total - m_passos;
+    while (!m_pontos.empty() && m_pontos.front().passo < mais_antigo) {
+        m_pontos.pop_front();
+    }
+    while (!m_marcos.empty() && m_marcos.front().passo < mais_antigo) {
+        m_marcos.pop_front();
+    }
+}
+
+void HistoricoExecucao::criarPonto(const Registradores& r, std::uint64_t instrucoes, Memoria& memoria) {
+    if (m_pontos.size() == MAX_PONTOS) {
+        m_pontos.pop_front();
+    }
+    m_pontos.push_back(PontoRestauracao{m_total, m_fim, r, instrucoes, Memoria(m_tamanho_memoria / 3)});
+    memoria.compartilharPaginas(); // a execução continua escrevendo nela
+    m_pontos.back().memoria.copiarPaginasDe(memoria);
+}
+
+/*
+=========================================================================================
+Desfaz a entrada mais recente: os bytes voltam na ordem inversa das escritas (o primeiro
+byte antigo de um endereço escrito duas vezes é o que fica), depois os registradores.
+=========================================================================================
+*/
+void HistoricoExecucao::desfazerUltima(Registradores& r, std::uint64_t& instrucoes, Memoria& memoria) {
+    const std::uint32_t cabecalho = palavra(m_fim - 1);
+    const std::uint32_t mascara = cabecalho & ((1u << BITS_MASCARA) - 1);
+    const std::size_t bytes = cabecalho >> BITS_MASCARA;
+    const std::uint64_t inicio = m_fim - (2 + bytes + palavrasRegistradores(mascara));
+
+    std::uint64_t pos = inicio + 1;
+    for (std::size_t k = bytes; k-- > 0;) {
+        const std::uint32_t anotado = palavra(pos + k);
+        memoria.setByte(anotado >> 8, anotado & 0xFF);
+    }
+    pos += bytes;
+
+    std::int32_t Registradores::*campos[7] = {&Registradores::A, &Registradores::X, &Registradores::L,
+                                               &Registradores::B, &Registradores::S, &Registradores::T,
+                                               &Registradores::PC};
+    for (int k = 0; k < 7; ++k) {
+        if (mascara & (1u << k)) {
+            r.*campos[k] = static_cast<std::int32_t>(palavra(pos++));
+        }
+    }
+    if (mascara & ALTEROU_STATUS) {
+        desempacotarStatus(r, palavra(pos++));
+    }
+    if (mascara & ALTEROU_F) {
+        const std::uint64_t bits = palavra(pos) | (std::uint64_t{palavra(pos + 1)} << 32);
+        std::memcpy(&r.F, &bits, sizeof bits);
+        pos += 2;
+    }
+    if (mascara & INSTRUCOES_DIFERENTE) {
+        instrucoes -= palavra(pos) | (std::uint64_t{palavra(pos + 1)} << 32);
+    } else {
+        instrucoes -= 1;
+    }
+
+    m_fim = inicio;
+    --m_passos;
+    --m_total;
+}
+
+/*
+=========================================================================================
+Voltar 'n' passos. Se houver um ponto de restauração entre o alvo e o passo atual, o
+mais próximo do alvo é restaurado de uma vez e só as entradas entre ele e o alvo são
+desfeitas uma a uma.
+=========================================================================================
+*/
+std::size_t HistoricoExecucao::voltar(std::size_t n, Registradores& r, std::uint64_t& instrucoes, Memoria& memoria) {
+    n = std::min(n, m_passos);
+    const std::uint64_t alvo = m_total - n;
+
+    auto ponto = std::find_if(m_pontos.begin(), m_pontos.end(),
+                              [alvo](const PontoRestauracao& p) { return p.passo >= alvo; });
+    if (ponto != m_pontos.end() && ponto->passo < m_total) {
+        memoria.copiarPaginasDe(ponto->memoria);
+        r = ponto->r;
+        instrucoes = ponto->instrucoes;
+        m_passos -= m_total - ponto->passo;
+        m_total = ponto->passo;
+        m_fim = ponto->posicao;
+    }
+    while (m_total > alvo) {
+        desfazerUltima(r, instrucoes, memoria);
+    }
+    while (!m_pontos.empty() && m_pontos.back().passo > m_total) {
+        m_pontos.pop_back();
+    }
+    while (!m_marcos.empty() && m_marcos.back().passo >= m_total) {
+        m_marcos.pop_back(); // o passo m_total será gravado de novo, e o marco com ele
+    }
+    return n;
+}
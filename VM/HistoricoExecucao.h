@@ -0,0 +1,98 @@
+#ifndef VM_SIC_HISTORICOEXECUCAO_H
+#define VM_SIC_HISTORICOEXECUCAO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "CPU.h"
+#include "Memoria.h"
+
+// Histórico para voltar passos: Maquina::passo() deixa aqui, por instrução, só o que ela
+// mudou (registradores alterados com o valor antigo, bytes sobrescritos com o byte antigo,
+// vindos do diário de desfazer da Memoria). As entradas ficam num anel de palavras; cheio,
+// as mais antigas são descartadas. A cada INTERVALO_PONTOS passos guarda também um ponto
+// de restauração completo (registradores e páginas, compartilhadas com cópia na escrita):
+// para voltar muitos passos, restaura o ponto logo depois do alvo e desfaz só o resto.
+//
+// Só a CPU, a memória e o contador de instruções voltam. Dispositivos, agenda de eventos,
+// interrupções pendentes e a tabela de páginas (LPT) ficam como estão.
+class HistoricoExecucao {
+public:
+    static constexpr std::size_t PALAVRAS_PADRAO = std::size_t{1} << 22; // 16 MB
+    static constexpr std::uint64_t INTERVALO_PONTOS = 1 << 16;
+    static constexpr std::size_t MAX_PONTOS = 8;
+
+    // 'palavras' é arredondado para potência de 2
+    explicit HistoricoExecucao(std::size_t tamanho_memoria_bytes, std::size_t palavras = PALAVRAS_PADRAO);
+
+    // Em volta de cada passo(), da thread que executa a máquina
+    void iniciarPasso(const Registradores& r, std::uint64_t instrucoes, Memoria& memoria) {
+        m_antes = r;
+        m_instrucoes_antes = instrucoes;
+        m_diario.clear();
+        memoria.setDiarioDesfazer(&m_diario);
+    }
+    void concluirPasso(const Registradores& r, std::uint64_t instrucoes, Memoria& memoria);
+
+    // Passos que ainda podem ser desfeitos
+    std::size_t getPassos() const { return m_passos; }
+    // Desfaz até 'n' passos; retorna quantos foram desfeitos
+    std::size_t voltar(std::size_t n, Registradores& r, std::uint64_t& instrucoes, Memoria& memoria);
+    void limpar();
+
+private:
+    // Entrada: [cabeçalho][bytes antigos][registradores antigos][cabeçalho]. O cabeçalho
+    // repetido nas duas pontas deixa o anel ser percorrido nos dois sentidos.
+    // Cabeçalho: bits 0-9 ALTEROU_*, bits 10-31 número de bytes antigos.
+    enum : std::uint32_t {
+        ALTEROU_A = 1 << 0, ALTEROU_X = 1 << 1, ALTEROU_L = 1 << 2, ALTEROU_B = 1 << 3,
+        ALTEROU_S = 1 << 4, ALTEROU_T = 1 << 5, ALTEROU_PC = 1 << 6,
+        ALTEROU_STATUS = 1 << 7,     // SW, modo, máscara e ICODE numa palavra
+        ALTEROU_F = 1 << 8,          // duas palavras
+        INSTRUCOES_DIFERENTE = 1 << 9 // o passo não contou exatamente uma instrução (duas palavras)
+    };
+    static constexpr unsigned BITS_MASCARA = 10;
+    static constexpr std::size_t FRACAO_DESCARTE = 16; // anel cheio: libera 1/16 dele
+    static constexpr std::uint64_t PASSOS_POR_MARCO = 1024;
+    static constexpr std::size_t MAX_BYTES_ENTRADA = (std::size_t{1} << (32 - BITS_MASCARA)) - 1;
+
+    struct PontoRestauracao {
+        std::uint64_t passo;   // valor de m_total quando foi criado
+        std::uint64_t posicao; // m_fim nesse momento
+        Registradores r;
+        std::uint64_t instrucoes;
+        Memoria memoria;
+    };
+
+    std::vector<std::uint32_t> m_anel;
+    std::uint64_t m_mascara_anel;
+    std::uint64_t m_inicio = 0;  // posições absolutas no anel (índice = posição & m_mascara_anel)
+    std::uint64_t m_fim = 0;
+    std::size_t m_passos = 0;    // entradas no anel
+    std::uint64_t m_total = 0;   // passos gravados desde limpar(), menos os desfeitos
+    std::size_t m_tamanho_memoria;
+    std::deque<PontoRestauracao> m_pontos; // em ordem de passo
+
+    // Onde começa a entrada de cada passo múltiplo de PASSOS_POR_MARCO: o descarte pula
+    // de marco em marco em vez de ler os cabeçalhos de cada entrada
+    struct Marco {
+        std::uint64_t passo;
+        std::uint64_t posicao;
+    };
+    std::deque<Marco> m_marcos;
+
+    Registradores m_antes;
+    std::uint64_t m_instrucoes_antes = 0;
+    std::vector<std::uint32_t> m_diario; // diário de desfazer da Memoria durante o passo
+
+    static std::size_t palavrasRegistradores(std::uint32_t mascara);
+    std::uint32_t& palavra(std::uint64_t posicao) { return m_anel[posicao & m_mascara_anel]; }
+    void descartarMaisAntiga();
+    void liberarEspaco(std::size_t palavras);
+    void descartarPontosAntigos();
+    void desfazerUltima(Registradores& r, std::uint64_t& instrucoes, Memoria& memoria);
+    void criarPonto(const Registradores& r, std::uint64_t instrucoes, Memoria& memoria);
+};
+
+#endif //VM_SIC_HISTORICOEXECUCAO_H
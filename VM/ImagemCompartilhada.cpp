@@ -0,0 +1,36 @@
+#include "ImagemCompartilhada.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+ImagemCompartilhada::ImagemCompartilhada(const std::vector<std::uint8_t>& bytes) : m_tamanho(bytes.size()) {
+    std::size_t paginas = (m_tamanho + TAMANHO_PAGINA - 1) >> PAGINA_BITS;
+    m_paginas.reserve(paginas);
+    for (std::size_t p = 0; p < paginas; ++p) {
+        auto pagina = std::make_shared<Pagina>();
+        std::size_t inicio = p << PAGINA_BITS;
+        std::size_t n = std::min(TAMANHO_PAGINA, m_tamanho - inicio);
+        std::copy_n(bytes.begin() + inicio, n, pagina->begin());
+        m_paginas.push_back(std::move(pagina));
+    }
+
+    // Decodifica todos os endereços uma vez: não se sabe de antemão onde começam as
+    // instruções, e as instâncias que usam a imagem não precisam repetir o trabalho.
+    auto byte = [&bytes](std::size_t endereco) -> std::uint8_t {
+        return endereco < bytes.size() ? bytes[endereco] : 0;
+    };
+    m_decodificadas.reserve(m_tamanho);
+    for (std::size_t endereco = 0; endereco < m_tamanho; ++endereco) {
+        m_decodificadas.push_back(decodificar(byte(endereco), byte(endereco + 1), byte(endereco + 2), byte(endereco + 3)));
+    }
+}
+
+std::shared_ptr<const ImagemCompartilhada> ImagemCompartilhada::carregarArquivo(const std::string& caminhoArquivo) {
+    std::ifstream arquivo(caminhoArquivo, std::ios::binary);
+    if (!arquivo) {
+        throw std::runtime_error("Erro ao abrir o arquivo: " + caminhoArquivo);
+    }
+    std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(arquivo)), std::istreambuf_iterator<char>());
+    return std::make_shared<const ImagemCompartilhada>(bytes);
+}
@@ -0,0 +1,27 @@
+#ifndef VM_SIC_IMAGEMCOMPARTILHADA_H
+#define VM_SIC_IMAGEMCOMPARTILHADA_H
+
+#include "Memoria.h"
+#include "Decodificador.h"
+#include <string>
+
+// Programa carregado uma única vez e dividido em páginas somente leitura. Várias
+// Memorias podem mapear as mesmas páginas (copiando só as que escreverem) e
+// reaproveitar as instruções que a imagem já decodificou.
+class ImagemCompartilhada {
+private:
+    std::size_t m_tamanho;
+    std::vector<std::shared_ptr<Pagina>> m_paginas;
+    std::vector<InstrucaoDecodificada> m_decodificadas; // uma por endereço de byte
+
+public:
+    explicit ImagemCompartilhada(const std::vector<std::uint8_t>& bytes);
+
+    static std::shared_ptr<const ImagemCompartilhada> carregarArquivo(const std::string& caminhoArquivo);
+
+    std::size_t getTamanho() const { return m_tamanho; }
+    const std::vector<std::shared_ptr<Pagina>>& getPaginas() const { return m_paginas; }
+    const InstrucaoDecodificada& getDecodificada(std::size_t endereco) const { return m_decodificadas[endereco]; }
+};
+
+#endif //VM_SIC_IMAGEMCOMPARTILHADA_H
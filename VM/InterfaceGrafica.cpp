@@ -4,18 +4,41 @@
 #include <QDebug>
 #include <QApplication>
 #include <QColor>
+#include <QStatusBar>
+#include <QDockWidget>
+#include <QSplitter>
+#include <QSignalBlocker>
+#include "JanelaRastro.h"
 
 
 InterfaceGrafica::InterfaceGrafica(QWidget *parent)
-    : QMainWindow(parent), vm(131072)
+    : QMainWindow(parent), vm(131072), perfil(vm.getMemoria().getTamanhoBytes()),
+      historico(vm.getMemoria().getTamanhoBytes())
 {
+    vm.setHistorico(&historico);
+    // A tabela de memória só repinta as linhas escritas desde a última atualização
+    vm.getMemoria().setRegistroEscritas(true, LIMITE_REGISTRO_ESCRITAS);
+
     configurarLayout();
+    configurarExecucao();
+    configurarDesempenho();
+#ifdef VM_SIC_MAPA_ACESSOS
+    configurarMapaCalor();
+#endif
     setWindowTitle("SIC/XE Virtual Machine");
     
-    resize(800, 600);
+    resize(1150, 650);
     
     atualizarRegistradores();
-    atualizarMemoria();
+    atualizarMemoria(true);
+}
+
+InterfaceGrafica::~InterfaceGrafica()
+{
+    // A thread só sai do laço de eventos depois que executar() retornar
+    vm.solicitarParada();
+    threadExecucao->quit();
+    threadExecucao->wait();
 }
 
 void InterfaceGrafica::configurarLayout()
@@ -29,29 +52,141 @@ void InterfaceGrafica::configurarLayout()
     btnCarregar = new QPushButton("Carregar Programa");
     btnExecutar = new QPushButton("Executar");
     btnPasso = new QPushButton("Passo");
+    btnVoltar = new QPushButton("Voltar");
+    btnVoltar->setEnabled(false);
+    spnVoltar = new QSpinBox();
+    spnVoltar->setRange(1, 1000000);
+    spnVoltar->setSuffix(" passo(s)");
+    btnParar = new QPushButton("Parar");
+    btnParar->setEnabled(false);
+    btnGravarRastro = new QPushButton("Gravar Rastro");
+    btnGravarRastro->setCheckable(true);
+    btnAbrirRastro = new QPushButton("Abrir Rastro");
     
     // Conexões de Slots
     connect(btnCarregar, &QPushButton::clicked, this, &InterfaceGrafica::carregarPrograma_clicked);
     connect(btnExecutar, &QPushButton::clicked, this, &InterfaceGrafica::executar_clicked);
     connect(btnPasso, &QPushButton::clicked, this, &InterfaceGrafica::passo_clicked);
+    connect(btnVoltar, &QPushButton::clicked, this, &InterfaceGrafica::voltar_clicked);
+    connect(btnParar, &QPushButton::clicked, this, &InterfaceGrafica::parar_clicked);
+    connect(btnGravarRastro, &QPushButton::toggled, this, &InterfaceGrafica::gravarRastro_toggled);
+    connect(btnAbrirRastro, &QPushButton::clicked, this, &InterfaceGrafica::abrirRastro_clicked);
 
     mainLayout->addWidget(btnCarregar, 0, 0);
     mainLayout->addWidget(btnExecutar, 0, 1);
     mainLayout->addWidget(btnPasso, 0, 2);
+    mainLayout->addWidget(btnVoltar, 0, 3);
+    mainLayout->addWidget(spnVoltar, 0, 4);
+    mainLayout->addWidget(btnParar, 0, 5);
+    mainLayout->addWidget(btnGravarRastro, 0, 6);
+    mainLayout->addWidget(btnAbrirRastro, 0, 7);
 
     // --- Registradores (Linha 1 e 2) ---
     configurarRegistradores();
-    mainLayout->addWidget(new QLabel("Registradores (Hex/Dec):"), 1, 0, 1, 3);
-    mainLayout->addWidget(tblRegistradores, 2, 0, 1, 3);
+    mainLayout->addWidget(new QLabel("Registradores (Hex/Dec):"), 1, 0, 1, 8);
+    mainLayout->addWidget(tblRegistradores, 2, 0, 1, 8);
 
-    // --- Memória (Linha 3 e 4) ---
+    // --- Memória e desmontagem lado a lado (Linha 3 e 4) ---
     configurarMemoria();
-    mainLayout->addWidget(new QLabel("Memória:"), 3, 0, 1, 3);
-    mainLayout->addWidget(tblMemoria, 4, 0, 1, 3);
+    visaoDesmontagem = new VisaoDesmontagem(vm.getMemoria());
+    QSplitter *divisorMemoria = new QSplitter(Qt::Horizontal);
+    divisorMemoria->addWidget(tblMemoria);
+    divisorMemoria->addWidget(visaoDesmontagem);
+    mainLayout->addWidget(new QLabel("Memória / Desmontagem:"), 3, 0, 1, 8);
+    mainLayout->addWidget(divisorMemoria, 4, 0, 1, 8);
     
     mainLayout->setRowStretch(4, 1); 
 }
 
+void InterfaceGrafica::configurarExecucao()
+{
+    threadExecucao = new QThread(this);
+    executor = new ExecutorVM(vm);
+    executor->moveToThread(threadExecucao);
+
+    connect(threadExecucao, &QThread::finished, executor, &QObject::deleteLater);
+    connect(this, &InterfaceGrafica::iniciarExecucao, executor, &ExecutorVM::executar);
+    connect(executor, &ExecutorVM::terminou, this, &InterfaceGrafica::execucao_terminou);
+
+    timerInstantaneo = new QTimer(this);
+    timerInstantaneo->setInterval(INTERVALO_INSTANTANEO_MS);
+    connect(timerInstantaneo, &QTimer::timeout, this, &InterfaceGrafica::mostrarInstantaneo);
+
+    threadExecucao->start();
+}
+
+void InterfaceGrafica::configurarDesempenho()
+{
+    painelDesempenho = new PainelDesempenho(perfil);
+    // O perfil custa um pouco por instrução: só conta quando o painel pede
+    connect(painelDesempenho, &PainelDesempenho::coletaAlterada, this, [this](bool ligada) {
+        vm.setPerfil(ligada ? &perfil : nullptr);
+    });
+
+    QDockWidget *dock = new QDockWidget("Desempenho", this);
+    dock->setWidget(painelDesempenho);
+    addDockWidget(Qt::RightDockWidgetArea, dock);
+}
+
+#ifdef VM_SIC_MAPA_ACESSOS
+void InterfaceGrafica::configurarMapaCalor()
+{
+    mapaCalor = new MapaCalorMemoria(vm.getMapaAcessos());
+
+    QDockWidget *dock = new QDockWidget("Acessos à memória", this);
+    dock->setWidget(mapaCalor);
+    addDockWidget(Qt::RightDockWidgetArea, dock);
+}
+#endif
+
+void InterfaceGrafica::setExecutando(bool executando)
+{
+    m_executando = executando;
+    btnCarregar->setEnabled(!executando);
+    btnExecutar->setEnabled(!executando);
+    btnPasso->setEnabled(!executando);
+    btnParar->setEnabled(executando);
+    spnVoltar->setEnabled(!executando);
+    atualizarVoltar();
+    btnGravarRastro->setEnabled(!executando); // m_rastro não muda com a máquina rodando
+    btnAbrirRastro->setEnabled(!executando);
+    modeloMemoria->setExecutando(executando);
+    visaoDesmontagem->setExecutando(executando);
+    painelDesempenho->setColetaEditavel(!executando); // m_perfil não muda com a máquina rodando
+
+    if (executando) {
+        atualizarJanelaInstantaneo();
+        executor->setPCsCodigo(painelDesempenho->pcsQuentes());
+        painelDesempenho->iniciarExecucao();
+        timerInstantaneo->start();
+    } else {
+        timerInstantaneo->stop();
+    }
+}
+
+// Voltar só com a máquina parada e algo no histórico
+void InterfaceGrafica::atualizarVoltar()
+{
+    btnVoltar->setEnabled(!m_executando && historico.getPassos() > 0);
+    btnVoltar->setToolTip(QString("%1 passos podem ser desfeitos").arg(historico.getPassos()));
+}
+
+// Linhas visíveis da tabela de memória: é o que o ExecutorVM copia em cada instantâneo
+void InterfaceGrafica::atualizarJanelaInstantaneo()
+{
+    const int linhas = modeloMemoria->rowCount();
+    int primeira = tblMemoria->rowAt(0);
+    int ultima = tblMemoria->rowAt(tblMemoria->viewport()->height() - 1);
+    if (primeira < 0) {
+        primeira = 0;
+    }
+    if (ultima < 0) {
+        ultima = linhas - 1;
+    }
+    executor->setJanela(static_cast<std::uint32_t>(primeira) * 3,
+                        static_cast<std::uint32_t>(ultima - primeira + 1) * 3);
+}
+
 void InterfaceGrafica::configurarRegistradores()
 {
     tblRegistradores = new QTableWidget(2, 8); 
@@ -71,24 +206,17 @@ void InterfaceGrafica::configurarRegistradores()
 
 void InterfaceGrafica::configurarMemoria()
 {
-    const size_t tamanho_bytes = vm.getMemoria().getTamanhoBytes();
-    const size_t palavras = tamanho_bytes / 3;
-    
-    tblMemoria = new QTableWidget(palavras, 2); 
-    tblMemoria->setHorizontalHeaderLabels({"Endereço", "Valor"});
+    // As linhas são formatadas pelo modelo só quando ficam visíveis
+    modeloMemoria = new ModeloMemoria(vm.getMemoria(), this);
+
+    tblMemoria = new QTableView();
+    tblMemoria->setModel(modeloMemoria);
     tblMemoria->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     tblMemoria->verticalHeader()->setVisible(false);
-    
-    for (size_t i = 0; i < palavras; ++i) {
-        QTableWidgetItem *addrItem = new QTableWidgetItem(QString("0x%1").arg(i * 3, 4, 16, QChar('0')).toUpper());
-        addrItem->setFlags(addrItem->flags() & ~Qt::ItemIsEditable);
-
-        QTableWidgetItem *valItem = new QTableWidgetItem("0x000000");
-        valItem->setFlags(valItem->flags() & ~Qt::ItemIsEditable);
-        
-        tblMemoria->setItem(i, 0, addrItem);
-        tblMemoria->setItem(i, 1, valItem);
-    }
+    // Altura fixa: a view calcula a posição de qualquer linha sem medir as outras
+    tblMemoria->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    tblMemoria->verticalHeader()->setDefaultSectionSize(tblMemoria->fontMetrics().height() + 6);
+    tblMemoria->setSelectionBehavior(QAbstractItemView::SelectRows);
 }
 
 // Implementações dos Slots
@@ -99,8 +227,15 @@ void InterfaceGrafica::carregarPrograma_clicked()
     if (!caminhoArquivo.isEmpty()) {
         try {
             vm.carregarPrograma(caminhoArquivo.toStdString());
+            perfil.zerar();
+            painelDesempenho->limpar();
+#ifdef VM_SIC_MAPA_ACESSOS
+            vm.getMapaAcessos().zerar();
+            mapaCalor->atualizar();
+#endif
             atualizarRegistradores();
-            atualizarMemoria();
+            atualizarMemoria(true); // a carga grava byte a byte no registro e em geral o estoura: repinta tudo
+            atualizarVoltar();
         } catch (const std::exception& e) {
             QMessageBox::critical(this, "Erro de Carregamento", QString("Erro ao carregar o programa: %1").arg(e.what()));
         }
@@ -109,12 +244,109 @@ void InterfaceGrafica::carregarPrograma_clicked()
 
 void InterfaceGrafica::executar_clicked()
 {
+    if (m_executando) {
+        return;
+    }
+    vm.descartarPedidoParada(); // um Parar clicado depois do fim da execução anterior
+    setExecutando(true);
+    statusBar()->showMessage("Executando...");
+    emit iniciarExecucao();
+}
+
+void InterfaceGrafica::parar_clicked()
+{
+    vm.solicitarParada(); // atendido antes da próxima instrução, mesmo esperando dispositivo
+}
+
+void InterfaceGrafica::gravarRastro_toggled(bool gravar)
+{
+    if (!gravar) {
+        vm.setRastro(nullptr);
+        gravadorRastro.reset(); // descarrega e fecha o arquivo
+        statusBar()->showMessage("Gravação do rastro encerrada");
+        return;
+    }
+
+    QString caminhoArquivo = QFileDialog::getSaveFileName(this, "Gravar Rastro", "", "Rastros (*.rastro);;Todos os Arquivos (*)");
+    if (caminhoArquivo.isEmpty()) {
+        QSignalBlocker bloqueio(btnGravarRastro);
+        btnGravarRastro->setChecked(false);
+        return;
+    }
     try {
-        vm.executar();
-        atualizarRegistradores();
-        atualizarMemoria();
+        gravadorRastro = std::make_unique<GravadorRastro>(caminhoArquivo.toStdString());
+        vm.setRastro(gravadorRastro.get());
+        statusBar()->showMessage("Gravando o rastro em " + caminhoArquivo);
+    } catch (const std::exception& e) {
+        QSignalBlocker bloqueio(btnGravarRastro);
+        btnGravarRastro->setChecked(false);
+        QMessageBox::critical(this, "Erro de Rastro", QString("Erro ao criar o rastro: %1").arg(e.what()));
+    }
+}
+
+void InterfaceGrafica::abrirRastro_clicked()
+{
+    QString caminhoArquivo = QFileDialog::getOpenFileName(this, "Abrir Rastro", "", "Rastros (*.rastro);;Todos os Arquivos (*)");
+    if (caminhoArquivo.isEmpty()) {
+        return;
+    }
+    if (gravadorRastro) {
+        gravadorRastro->descarregar(); // o arquivo aberto pode ser o que está sendo gravado
+    }
+    try {
+        JanelaRastro *janela = new JanelaRastro(caminhoArquivo, this);
+        janela->show();
     } catch (const std::exception& e) {
-        QMessageBox::critical(this, "Erro de Execução", QString("Erro durante a execução: %1").arg(e.what()));
+        QMessageBox::critical(this, "Erro de Rastro", QString("Erro ao abrir o rastro: %1").arg(e.what()));
+    }
+}
+
+void InterfaceGrafica::mostrarInstantaneo()
+{
+    // A janela pedida agora vale a partir da próxima fatia
+    atualizarJanelaInstantaneo();
+
+    BufferTriplo<InstantaneoVM>& buffer = executor->instantaneos();
+    if (!buffer.atualizar()) {
+        return;
+    }
+    const InstantaneoVM& inst = buffer.leitura();
+    mostrarRegistradores(inst.r);
+    modeloMemoria->setInstantaneo(&inst);
+    modeloMemoria->setPC(inst.r.PC);
+    painelDesempenho->amostrar(inst);
+#ifdef VM_SIC_MAPA_ACESSOS
+    mapaCalor->atualizarPeriodico(); // os contadores são lidos direto, sem passar pelo instantâneo
+#endif
+    executor->setPCsCodigo(painelDesempenho->pcsQuentes());
+    statusBar()->showMessage(QString("Executando... %1 instruções").arg(inst.instrucoes));
+}
+
+void InterfaceGrafica::execucao_terminou(int falha, QString erro)
+{
+    executor->instantaneos().atualizar(); // descarta o da última fatia; a próxima execução começa limpa
+    setExecutando(false);
+    atualizarRegistradores();
+    atualizarMemoria();
+    painelDesempenho->atualizarParado(vm.getMemoria());
+#ifdef VM_SIC_MAPA_ACESSOS
+    mapaCalor->atualizar();
+#endif
+
+    switch (static_cast<Falha>(falha)) {
+        case Falha::INTERROMPIDA:
+            statusBar()->showMessage("Execução interrompida");
+            break;
+        case Falha::EXCECAO:
+            statusBar()->showMessage("Execução terminou com erro");
+            QMessageBox::critical(this, "Erro de Execução", QString("Erro durante a execução: %1").arg(erro));
+            break;
+        case Falha::PC_FORA_DOS_LIMITES:
+            statusBar()->showMessage("Execução terminou: PC fora dos limites da memória");
+            break;
+        default:
+            statusBar()->showMessage("Execução terminada");
+            break;
     }
 }
 
@@ -124,17 +356,39 @@ void InterfaceGrafica::passo_clicked()
         vm.passo();
         atualizarRegistradores();
         atualizarMemoria();
+        painelDesempenho->atualizarParado(vm.getMemoria());
+#ifdef VM_SIC_MAPA_ACESSOS
+        mapaCalor->atualizar();
+#endif
+        atualizarVoltar();
     } catch (const std::exception& e) {
         QMessageBox::critical(this, "Erro de Passo", QString("Erro durante o passo: %1").arg(e.what()));
+        atualizarVoltar(); // o passo que falhou também entra no histórico
     }
 }
 
+void InterfaceGrafica::voltar_clicked()
+{
+    // Registradores, memória e contador voltam; dispositivos e perfil não
+    const std::size_t voltou = vm.voltarPassos(static_cast<std::size_t>(spnVoltar->value()));
+    atualizarRegistradores();
+    atualizarMemoria();
+    painelDesempenho->atualizarParado(vm.getMemoria());
+    atualizarVoltar();
+    statusBar()->showMessage(QString("Voltou %1 passo(s); instrução %2")
+                                 .arg(voltou)
+                                 .arg(vm.getContadorInstrucoes()));
+}
+
 // Funções de atualização da UI (inalteradas)
 void InterfaceGrafica::atualizarRegistradores()
 {
-    Registradores& r = vm.getCPU().r;
+    mostrarRegistradores(vm.getCPU().r);
+}
 
-    std::vector<std::pair<std::int32_t*, int>> regs = {
+void InterfaceGrafica::mostrarRegistradores(const Registradores& r)
+{
+    std::vector<std::pair<const std::int32_t*, int>> regs = {
         {&r.A, 0}, {&r.X, 1}, {&r.L, 2}, {&r.B, 3},
         {&r.S, 4}, {&r.T, 5}, {&r.PC, 6}
     };
@@ -166,44 +420,23 @@ void InterfaceGrafica::atualizarRegistradores()
 }
 
 
-void InterfaceGrafica::atualizarMemoria()
+void InterfaceGrafica::atualizarMemoria(bool tudo)
 {
-    const std::vector<std::uint8_t>& m_bytes = vm.getMemoria().getMBytes();
-    const size_t tamanho_bytes = m_bytes.size();
-    const size_t palavras = tamanho_bytes / 3;
+    Memoria& memoria = vm.getMemoria();
     const std::int32_t pc_atual = vm.getCPU().r.PC;
-    
-    QPalette palette = tblMemoria->palette();
-    QColor corFundoPadrao = palette.color(QPalette::Base);
-    QColor corDestaque = QColor(170, 200, 255); 
-
-
-    for (size_t i = 0; i < palavras; ++i) {
-        size_t byte_addr = i * 3;
-        
-        std::uint32_t palavra = 0;
-        if (byte_addr + 2 < tamanho_bytes) {
-             palavra = (m_bytes[byte_addr] << 16) | 
-                       (m_bytes[byte_addr + 1] << 8) | 
-                        m_bytes[byte_addr + 2];
-        }
-        
-        QString valStr = QString("0x%1").arg(palavra, 6, 16, QChar('0')).toUpper();
-        tblMemoria->item(i, 1)->setText(valStr);
 
-        bool isPC = (byte_addr == pc_atual);
-        
-        for (int col = 0; col < tblMemoria->columnCount(); ++col) {
-            if (isPC) {
-                tblMemoria->item(i, col)->setBackground(corDestaque);
-            } else {
-                tblMemoria->item(i, col)->setBackground(corFundoPadrao); 
-            }
-        }
+    if (tudo || memoria.registroTransbordou()) {
+        modeloMemoria->atualizarTudo();
+        visaoDesmontagem->invalidarTudo();
+    } else {
+        modeloMemoria->atualizarEnderecos(memoria.getRegistroEscritas());
+        visaoDesmontagem->invalidar(memoria.getRegistroEscritas());
     }
+    memoria.limparRegistroEscritas();
+    modeloMemoria->setPC(pc_atual);
+    visaoDesmontagem->setPC(pc_atual);
 
-    if (pc_atual >= 0 && pc_atual < tamanho_bytes) {
-        int row = pc_atual / 3;
-        tblMemoria->scrollTo(tblMemoria->model()->index(row, 0));
+    if (pc_atual >= 0 && static_cast<std::size_t>(pc_atual) < memoria.getTamanhoBytes()) {
+        tblMemoria->scrollTo(modeloMemoria->index(ModeloMemoria::linhaDoEndereco(pc_atual), 0));
     }
-}
\ No newline at end of file
+}
@@ -6,11 +6,26 @@
 #include <QLabel>
 #include <QGridLayout>
 #include <QTableWidget>
+#include <QTableView>
 #include <QHeaderView>
+#include <QThread>
+#include <QTimer>
+#include <QSpinBox>
 #include <map>
+#include <memory>
 #include <vector>
 #include "Maquina_melhor.h" 
 #include "CPU.h"
+#include "ModeloMemoria.h"
+#include "ExecutorVM.h"
+#include "PainelDesempenho.h"
+#include "VisaoDesmontagem.h"
+#include "PerfilExecucao.h"
+#include "Rastro.h"
+#include "HistoricoExecucao.h"
+#ifdef VM_SIC_MAPA_ACESSOS
+#include "MapaCalorMemoria.h"
+#endif
 
 // Usamos QMainWindow como a classe base da GUI
 class InterfaceGrafica : public QMainWindow
@@ -19,30 +34,75 @@ class InterfaceGrafica : public QMainWindow
 
 public:
     explicit InterfaceGrafica(QWidget *parent = nullptr);
-    ~InterfaceGrafica() override = default;
+    ~InterfaceGrafica() override;
+
+signals:
+    void iniciarExecucao(); // entregue ao ExecutorVM, na thread de execução
 
 private slots:
     // Slots para as funções de controle
     void carregarPrograma_clicked();
     void executar_clicked();
     void passo_clicked();
+    void voltar_clicked();
+    void parar_clicked();
+    void gravarRastro_toggled(bool gravar);
+    void abrirRastro_clicked();
+    // Avisos do ExecutorVM (chegam pela fila de eventos da GUI)
+    void execucao_terminou(int falha, QString erro);
+    // Mostra o último instantâneo publicado pelo ExecutorVM (timerInstantaneo)
+    void mostrarInstantaneo();
 
 private:
+    // Escritas registradas entre duas atualizações; acima disso a tabela é repintada inteira
+    static constexpr std::size_t LIMITE_REGISTRO_ESCRITAS = 1 << 16;
+    // Atualização da tela durante a execução (~30 Hz)
+    static constexpr int INTERVALO_INSTANTANEO_MS = 33;
+
     Maquina vm; // Instância da máquina virtual
+    PerfilExecucao perfil; // contadores do painel de desempenho (ligados pelo painel)
+    HistoricoExecucao historico; // sempre ligado: é o que o botão Voltar desfaz
+    std::unique_ptr<GravadorRastro> gravadorRastro; // ligado na máquina enquanto btnGravarRastro está marcado
 
     // Componentes da Interface
     QPushButton *btnCarregar;
     QPushButton *btnExecutar;
     QPushButton *btnPasso;
+    QPushButton *btnVoltar;
+    QSpinBox *spnVoltar; // quantos passos o Voltar desfaz
+    QPushButton *btnParar;
+    QPushButton *btnGravarRastro;
+    QPushButton *btnAbrirRastro;
     QTableWidget *tblRegistradores;
-    QTableWidget *tblMemoria;
+    QTableView *tblMemoria;
+    PainelDesempenho *painelDesempenho;
+#ifdef VM_SIC_MAPA_ACESSOS
+    MapaCalorMemoria *mapaCalor;
+#endif
+    ModeloMemoria *modeloMemoria;
+    VisaoDesmontagem *visaoDesmontagem;
+
+    // Execução em segundo plano. Enquanto m_executando, a GUI não lê a máquina.
+    QThread *threadExecucao;
+    ExecutorVM *executor;
+    bool m_executando = false;
+    QTimer *timerInstantaneo;
 
     // Funções de configuração e atualização
     void configurarLayout();
+    void configurarExecucao();
+    void configurarDesempenho();
+#ifdef VM_SIC_MAPA_ACESSOS
+    void configurarMapaCalor();
+#endif
+    void setExecutando(bool executando);
+    void atualizarVoltar();
+    void atualizarJanelaInstantaneo();
     void configurarRegistradores();
     void configurarMemoria();
     void atualizarRegistradores();
-    void atualizarMemoria();
+    void mostrarRegistradores(const Registradores& r);
+    void atualizarMemoria(bool tudo = false);
 };
 
 #endif // INTERFACEGRAFICA_H
\ No newline at end of file
@@ -0,0 +1,376 @@
+#include "JanelaRastro.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <QApplication>
+#include <QColor>
+#include <QGridLayout>
+#include <QHeaderView>
+#include <QHBoxLayout>
+#include "Decodificador.h"
+
+ModeloRastro::ModeloRastro(const LeitorRastro& leitor, QObject *parent)
+    : QAbstractTableModel(parent), m_leitor(leitor)
+{
+}
+
+int ModeloRastro::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    const std::size_t linhas = m_filtrado ? m_aceitos.size() : m_leitor.getQuantidade();
+    return static_cast<int>(std::min<std::size_t>(linhas, std::numeric_limits<int>::max()));
+}
+
+int ModeloRastro::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : NUM_COLUNAS;
+}
+
+/*
+=========================================================================================
+Formata uma célula no momento em que a view a pinta. O estado depois da instrução i é o
+registro i + 1; a última instrução do rastro não tem esse estado e fica em branco.
+=========================================================================================
+*/
+QVariant ModeloRastro::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    const std::size_t registro = registroDaLinha(index.row());
+    const RegistroRastro& reg = m_leitor[registro];
+    const int coluna = index.column();
+    const bool tem_depois = registro + 1 < m_leitor.getQuantidade();
+
+    if (role == Qt::BackgroundRole) {
+        if (coluna < COL_A || !tem_depois) {
+            return QVariant();
+        }
+        const std::uint8_t bit = coluna == COL_CC ? ALTEROU_CC : 1 << (coluna - COL_A);
+        return (m_leitor.alteradosPor(registro) & bit) ? QVariant(QColor(255, 220, 150)) : QVariant();
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (coluna) {
+        case COL_NUMERO:
+            return QString::number(registro);
+        case COL_PC:
+            return QString("0x%1").arg(reg.pc(), 4, 16, QChar('0')).toUpper();
+        case COL_INSTRUCAO:
+            return QString::fromStdString(
+                desmontar(decodificar(reg.bytes[0], reg.bytes[1], reg.bytes[2], reg.bytes[3]), reg.pc()));
+        default:
+            break;
+    }
+
+    if (!tem_depois) {
+        return QVariant();
+    }
+    const RegistroRastro& depois = m_leitor[registro + 1];
+    if (coluna == COL_CC) {
+        static const char* const nomes[3] = {"<", "=", ">"};
+        return depois.cc() < 3 ? QString(nomes[depois.cc()]) : QString("?");
+    }
+    const std::uint32_t valor = static_cast<std::uint32_t>(depois.regs[coluna - COL_A]) & 0xFFFFFF;
+    return QString("0x%1").arg(valor, 6, 16, QChar('0')).toUpper();
+}
+
+QVariant ModeloRastro::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    static const char* const nomes[NUM_COLUNAS] = {"Nº", "PC", "Instrução", "A", "X", "L", "B", "S", "T", "CC"};
+    return QString(nomes[section]);
+}
+
+void ModeloRastro::setFiltro(std::vector<std::uint32_t> aceitos)
+{
+    beginResetModel();
+    m_aceitos = std::move(aceitos);
+    m_filtrado = true;
+    endResetModel();
+}
+
+void ModeloRastro::limparFiltro()
+{
+    beginResetModel();
+    m_aceitos.clear();
+    m_aceitos.shrink_to_fit(); // pode ter milhões de entradas
+    m_filtrado = false;
+    endResetModel();
+}
+
+std::size_t ModeloRastro::registroDaLinha(int linha) const
+{
+    return m_filtrado ? m_aceitos[static_cast<std::size_t>(linha)] : static_cast<std::size_t>(linha);
+}
+
+int ModeloRastro::linhaDoRegistro(std::size_t registro) const
+{
+    if (!m_filtrado) {
+        return registro < m_leitor.getQuantidade() ? static_cast<int>(registro) : -1;
+    }
+    auto it = std::lower_bound(m_aceitos.begin(), m_aceitos.end(), registro);
+    return it == m_aceitos.end() ? -1 : static_cast<int>(it - m_aceitos.begin());
+}
+
+bool ModeloRastro::mostrado(std::size_t registro) const
+{
+    return !m_filtrado || std::binary_search(m_aceitos.begin(), m_aceitos.end(), registro);
+}
+
+/*
+=========================================================================================
+Janela. O mapeamento vale enquanto m_arquivo existir; o índice começa a ser montado
+aqui e a janela mostra o progresso até ele terminar.
+=========================================================================================
+*/
+JanelaRastro::JanelaRastro(const QString& caminho, QWidget *parent)
+    : QWidget(parent, Qt::Window), m_arquivo(caminho)
+{
+    if (!m_arquivo.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("Nao foi possivel abrir o rastro: " + m_arquivo.errorString().toStdString());
+    }
+    const qint64 tamanho = m_arquivo.size();
+    const uchar *dados = tamanho > 0 ? m_arquivo.map(0, tamanho) : nullptr;
+    if (!dados) {
+        throw std::runtime_error("Nao foi possivel mapear o rastro: " + m_arquivo.errorString().toStdString());
+    }
+    m_leitor = LeitorRastro(dados, static_cast<std::size_t>(tamanho));
+    m_indice = std::make_unique<IndiceRastro>(m_leitor);
+
+    setAttribute(Qt::WA_DeleteOnClose);
+    setWindowTitle(QString("Rastro - %1 (%2 instruções)").arg(caminho).arg(m_leitor.getQuantidade()));
+    resize(900, 600);
+
+    modelo = new ModeloRastro(m_leitor, this);
+    tblRastro = new QTableView();
+    tblRastro->setModel(modelo);
+    tblRastro->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    tblRastro->horizontalHeader()->setSectionResizeMode(ModeloRastro::COL_INSTRUCAO, QHeaderView::ResizeToContents);
+    tblRastro->verticalHeader()->setVisible(false);
+    // Altura fixa: a view calcula a posição de qualquer linha sem medir as outras
+    tblRastro->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    tblRastro->verticalHeader()->setDefaultSectionSize(tblRastro->fontMetrics().height() + 6);
+    tblRastro->setSelectionBehavior(QAbstractItemView::SelectRows);
+    tblRastro->setSelectionMode(QAbstractItemView::SingleSelection);
+
+    edtNumero = new QLineEdit();
+    edtNumero->setPlaceholderText("nº da instrução");
+    QPushButton *btnIrPara = new QPushButton("Ir para");
+
+    cmbCriterio = new QComboBox();
+    cmbCriterio->addItems({"PC", "Opcode", "Registrador alterado"});
+    edtValor = new QLineEdit();
+    edtValor->setPlaceholderText("0x1A3, LDA ou A/X/L/B/S/T/CC");
+    QPushButton *btnFiltrar = new QPushButton("Filtrar");
+    btnLimparFiltro = new QPushButton("Mostrar tudo");
+    btnLimparFiltro->setEnabled(false);
+    QPushButton *btnAnterior = new QPushButton("Anterior");
+    QPushButton *btnProximo = new QPushButton("Próximo");
+
+    lblEstado = new QLabel();
+
+    connect(btnIrPara, &QPushButton::clicked, this, &JanelaRastro::irPara_clicked);
+    connect(edtNumero, &QLineEdit::returnPressed, this, &JanelaRastro::irPara_clicked);
+    connect(btnFiltrar, &QPushButton::clicked, this, &JanelaRastro::filtrar_clicked);
+    connect(btnLimparFiltro, &QPushButton::clicked, this, &JanelaRastro::limparFiltro_clicked);
+    connect(btnAnterior, &QPushButton::clicked, this, &JanelaRastro::anterior_clicked);
+    connect(btnProximo, &QPushButton::clicked, this, &JanelaRastro::proximo_clicked);
+    connect(edtValor, &QLineEdit::returnPressed, this, &JanelaRastro::proximo_clicked);
+
+    QHBoxLayout *linhaIrPara = new QHBoxLayout();
+    linhaIrPara->addWidget(new QLabel("Instrução:"));
+    linhaIrPara->addWidget(edtNumero);
+    linhaIrPara->addWidget(btnIrPara);
+    linhaIrPara->addStretch(1);
+
+    QHBoxLayout *linhaCriterio = new QHBoxLayout();
+    linhaCriterio->addWidget(cmbCriterio);
+    linhaCriterio->addWidget(edtValor);
+    linhaCriterio->addWidget(btnAnterior);
+    linhaCriterio->addWidget(btnProximo);
+    linhaCriterio->addWidget(btnFiltrar);
+    linhaCriterio->addWidget(btnLimparFiltro);
+
+    QGridLayout *layout = new QGridLayout(this);
+    layout->addLayout(linhaIrPara, 0, 0);
+    layout->addLayout(linhaCriterio, 1, 0);
+    layout->addWidget(tblRastro, 2, 0);
+    layout->addWidget(lblEstado, 3, 0);
+    layout->setRowStretch(2, 1);
+
+    timerProgresso = new QTimer(this);
+    timerProgresso->setInterval(INTERVALO_PROGRESSO_MS);
+    connect(timerProgresso, &QTimer::timeout, this, &JanelaRastro::atualizarProgresso);
+    timerProgresso->start();
+    atualizarProgresso();
+}
+
+void JanelaRastro::atualizarProgresso()
+{
+    const std::size_t total = m_indice->getNumBlocos();
+    const std::size_t prontos = m_indice->blocosProntos();
+    if (prontos == total) {
+        timerProgresso->stop();
+        lblEstado->setText(QString("%1 instruções; índice pronto").arg(m_leitor.getQuantidade()));
+        return;
+    }
+    lblEstado->setText(QString("%1 instruções; montando o índice: %2%")
+                           .arg(m_leitor.getQuantidade())
+                           .arg(100 * prontos / total));
+}
+
+void JanelaRastro::mostrarRegistro(std::size_t registro)
+{
+    const int linha = modelo->linhaDoRegistro(registro);
+    if (linha < 0) {
+        return;
+    }
+    const QModelIndex indice = modelo->index(linha, 0);
+    tblRastro->scrollTo(indice, QAbstractItemView::PositionAtCenter);
+    tblRastro->selectRow(linha);
+}
+
+void JanelaRastro::irPara_clicked()
+{
+    bool ok = false;
+    const qulonglong numero = edtNumero->text().trimmed().toULongLong(&ok);
+    if (!ok || numero >= m_leitor.getQuantidade()) {
+        lblEstado->setText(QString("Número fora do rastro (0 a %1)").arg(m_leitor.getQuantidade() - 1));
+        return;
+    }
+    if (modelo->filtrado() && !modelo->mostrado(numero)) {
+        limparFiltro_clicked(); // a instrução pedida não passa no filtro
+    }
+    mostrarRegistro(numero);
+}
+
+/*
+=========================================================================================
+Critério da busca/filtro a partir da caixa e do texto: PC em hexadecimal, opcode pelo
+mnemônico ou em hexadecimal, registrador pelo nome.
+=========================================================================================
+*/
+bool JanelaRastro::lerCriterio(FiltroRastro& filtro)
+{
+    const QString texto = edtValor->text().trimmed().toUpper();
+    bool ok = false;
+    switch (cmbCriterio->currentIndex()) {
+        case 0:
+            filtro.tipo = FiltroRastro::Tipo::PC;
+            filtro.valor = (texto.startsWith("0X") ? texto.mid(2) : texto).toUInt(&ok, 16);
+            break;
+        case 1:
+            filtro.tipo = FiltroRastro::Tipo::OPCODE;
+            for (unsigned opcode = 0; opcode < 256 && !ok; opcode += 4) {
+                const char *mnemonico = infoOpcode(static_cast<std::uint8_t>(opcode)).mnemonico;
+                if (mnemonico && texto == mnemonico) {
+                    filtro.valor = opcode;
+                    ok = true;
+                }
+            }
+            if (!ok) {
+                filtro.valor = (texto.startsWith("0X") ? texto.mid(2) : texto).toUInt(&ok, 16);
+                ok = ok && filtro.valor < 256;
+            }
+            break;
+        default: {
+            filtro.tipo = FiltroRastro::Tipo::REGISTRADOR;
+            static const char* const nomes[6] = {"A", "X", "L", "B", "S", "T"};
+            for (int r = 0; r < 6 && !ok; ++r) {
+                if (texto == nomes[r]) {
+                    filtro.valor = 1u << r;
+                    ok = true;
+                }
+            }
+            if (!ok && (texto == "CC" || texto == "SW")) {
+                filtro.valor = ALTEROU_CC;
+                ok = true;
+            }
+            break;
+        }
+    }
+    if (!ok) {
+        lblEstado->setText(QString("Valor inválido para o critério \"%1\"").arg(cmbCriterio->currentText()));
+    }
+    return ok;
+}
+
+void JanelaRastro::filtrar_clicked()
+{
+    FiltroRastro filtro;
+    if (!lerCriterio(filtro)) {
+        return;
+    }
+    // Síncrono: com o índice pronto, os blocos sem nada que interesse nem são lidos
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    std::vector<std::uint32_t> aceitos = filtrarRastro(m_leitor, *m_indice, filtro);
+    QApplication::restoreOverrideCursor();
+
+    const std::size_t quantidade = aceitos.size();
+    modelo->setFiltro(std::move(aceitos));
+    btnLimparFiltro->setEnabled(true);
+    lblEstado->setText(QString("%1 instruções aceitas pelo filtro").arg(quantidade));
+}
+
+void JanelaRastro::limparFiltro_clicked()
+{
+    // Volta para a mesma instrução na lista completa
+    const QModelIndex atual = tblRastro->currentIndex();
+    const std::size_t registro = atual.isValid() ? modelo->registroDaLinha(atual.row()) : 0;
+    modelo->limparFiltro();
+    btnLimparFiltro->setEnabled(false);
+    if (m_leitor.getQuantidade() > 0) {
+        mostrarRegistro(registro);
+    }
+}
+
+void JanelaRastro::anterior_clicked()
+{
+    procurar(false);
+}
+
+void JanelaRastro::proximo_clicked()
+{
+    procurar(true);
+}
+
+// A busca anda pelo rastro inteiro a partir da linha selecionada; se cair numa instrução
+// escondida pelo filtro, o filtro é desfeito para mostrá-la
+void JanelaRastro::procurar(bool adiante)
+{
+    FiltroRastro filtro;
+    if (!lerCriterio(filtro)) {
+        return;
+    }
+    const QModelIndex atual = tblRastro->currentIndex();
+    std::size_t inicio;
+    if (!atual.isValid()) {
+        inicio = adiante ? 0 : m_leitor.getQuantidade();
+    } else {
+        const std::size_t registro = modelo->registroDaLinha(atual.row());
+        if (!adiante && registro == 0) {
+            lblEstado->setText("Nada encontrado");
+            return;
+        }
+        inicio = adiante ? registro + 1 : registro - 1;
+    }
+
+    const std::size_t achado = procurarRastro(m_leitor, *m_indice, filtro, inicio, adiante);
+    if (achado == SEM_REGISTRO) {
+        lblEstado->setText("Nada encontrado");
+        return;
+    }
+    if (!modelo->mostrado(achado)) {
+        limparFiltro_clicked();
+    }
+    mostrarRegistro(achado);
+    lblEstado->setText(QString("Instrução %1").arg(achado));
+}
@@ -0,0 +1,96 @@
+#ifndef VM_SIC_JANELARASTRO_H
+#define VM_SIC_JANELARASTRO_H
+
+#include <QAbstractTableModel>
+#include <QComboBox>
+#include <QFile>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QString>
+#include <QTableView>
+#include <QTimer>
+#include <QWidget>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Rastro.h"
+
+// Modelo da tabela do rastro: uma linha por instrução (ou por instrução aceita pelo
+// filtro), formatada só quando a view pede. As colunas dos registradores mostram o
+// estado DEPOIS da instrução, com os que ela mudou destacados.
+class ModeloRastro : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Coluna { COL_NUMERO = 0, COL_PC, COL_INSTRUCAO, COL_A, COL_X, COL_L, COL_B, COL_S, COL_T, COL_CC,
+                  NUM_COLUNAS };
+
+    explicit ModeloRastro(const LeitorRastro& leitor, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Mostra só as instruções de 'aceitos' (em ordem, de filtrarRastro)
+    void setFiltro(std::vector<std::uint32_t> aceitos);
+    void limparFiltro();
+    bool filtrado() const { return m_filtrado; }
+
+    std::size_t registroDaLinha(int linha) const;
+    // Linha da instrução 'registro' ou, com filtro, da primeira aceita depois dela (-1 se não houver)
+    int linhaDoRegistro(std::size_t registro) const;
+    // Com filtro, se a instrução está entre as mostradas
+    bool mostrado(std::size_t registro) const;
+
+private:
+    const LeitorRastro& m_leitor;
+    bool m_filtrado = false;
+    std::vector<std::uint32_t> m_aceitos;
+};
+
+// Janela do rastro binário: o arquivo é mapeado na memória e lido direto pelo modelo.
+// Ir para a instrução n é imediato (registros de tamanho fixo); filtros e buscas usam o
+// índice esparso, montado em segundo plano enquanto a janela já está em uso.
+class JanelaRastro : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int INTERVALO_PROGRESSO_MS = 100;
+
+    // Lança std::runtime_error se o arquivo não puder ser mapeado ou não for um rastro
+    explicit JanelaRastro(const QString& caminho, QWidget *parent = nullptr);
+
+private slots:
+    void irPara_clicked();
+    void filtrar_clicked();
+    void limparFiltro_clicked();
+    void anterior_clicked();
+    void proximo_clicked();
+    void atualizarProgresso();
+
+private:
+    // Nesta ordem: o índice lê o leitor, que lê o mapeamento do arquivo
+    QFile m_arquivo;
+    LeitorRastro m_leitor;
+    std::unique_ptr<IndiceRastro> m_indice;
+
+    ModeloRastro *modelo;
+    QTableView *tblRastro;
+    QLineEdit *edtNumero;
+    QComboBox *cmbCriterio;
+    QLineEdit *edtValor;
+    QPushButton *btnLimparFiltro;
+    QLabel *lblEstado;
+    QTimer *timerProgresso;
+
+    bool lerCriterio(FiltroRastro& filtro);
+    void procurar(bool adiante);
+    void mostrarRegistro(std::size_t registro);
+};
+
+#endif //VM_SIC_JANELARASTRO_H
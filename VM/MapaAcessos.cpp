@@ -0,0 +1,33 @@
+#include "MapaAcessos.h"
+#include <algorithm>
+
+MapaAcessos::MapaAcessos(std::size_t tamanho_memoria_bytes)
+    : m_leituras((tamanho_memoria_bytes + TAMANHO_LINHA_ACESSO - 1) >> LINHA_ACESSO_BITS),
+      m_escritas((tamanho_memoria_bytes + TAMANHO_LINHA_ACESSO - 1) >> LINHA_ACESSO_BITS) {
+}
+
+// Acesso que atravessa linhas (palavras na divisa, blocos da HCALL e dos laços acelerados)
+void MapaAcessos::somarFaixa(std::vector<std::atomic<std::uint64_t>>& contadores, std::size_t endereco,
+                             std::size_t bytes) {
+    const std::size_t fim = endereco + bytes;
+    while (endereco < fim) {
+        const std::size_t linha = endereco >> LINHA_ACESSO_BITS;
+        if (linha >= contadores.size()) {
+            return;
+        }
+        const std::size_t fim_linha = (linha + 1) << LINHA_ACESSO_BITS;
+        const std::size_t n = std::min(fim, fim_linha) - endereco;
+        auto& c = contadores[linha];
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        endereco += n;
+    }
+}
+
+void MapaAcessos::zerar() {
+    for (auto& c : m_leituras) {
+        c.store(0, std::memory_order_relaxed);
+    }
+    for (auto& c : m_escritas) {
+        c.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef VM_SIC_MAPAACESSOS_H
+#define VM_SIC_MAPAACESSOS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Linhas de 64 bytes: a granularidade do mapa de acessos
+constexpr std::size_t LINHA_ACESSO_BITS = 6;
+constexpr std::size_t TAMANHO_LINHA_ACESSO = std::size_t{1} << LINHA_ACESSO_BITS;
+
+// Bytes lidos e escritos em cada linha da memória física, para o mapa de calor da GUI.
+// Só existe na máquina compilada com VM_SIC_MAPA_ACESSOS. A busca de instruções conta
+// como leitura. Como em PerfilExecucao, um único escritor (a thread da máquina) incrementa
+// com load + store relaxados e a GUI lê os contadores a qualquer momento.
+class MapaAcessos {
+private:
+    std::vector<std::atomic<std::uint64_t>> m_leituras;
+    std::vector<std::atomic<std::uint64_t>> m_escritas;
+
+    static void somar(std::vector<std::atomic<std::uint64_t>>& contadores, std::size_t endereco, std::size_t bytes) {
+        std::size_t linha = endereco >> LINHA_ACESSO_BITS;
+        const std::size_t no_inicio = TAMANHO_LINHA_ACESSO - (endereco & (TAMANHO_LINHA_ACESSO - 1));
+        if (bytes <= no_inicio && linha < contadores.size()) { // o caso comum: uma linha só
+            auto& c = contadores[linha];
+            c.store(c.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+            return;
+        }
+        somarFaixa(contadores, endereco, bytes);
+    }
+    static void somarFaixa(std::vector<std::atomic<std::uint64_t>>& contadores, std::size_t endereco, std::size_t bytes);
+
+public:
+    explicit MapaAcessos(std::size_t tamanho_memoria_bytes);
+
+    // Escritor
+    void leitura(std::size_t endereco, std::size_t bytes) { somar(m_leituras, endereco, bytes); }
+    void escrita(std::size_t endereco, std::size_t bytes) { somar(m_escritas, endereco, bytes); }
+
+    // Leitores
+    std::size_t getNumLinhas() const { return m_leituras.size(); }
+    std::uint64_t leiturasDaLinha(std::size_t linha) const { return m_leituras[linha].load(std::memory_order_relaxed); }
+    std::uint64_t escritasDaLinha(std::size_t linha) const { return m_escritas[linha].load(std::memory_order_relaxed); }
+
+    // Só com a máquina parada
+    void zerar();
+};
+
+#endif //VM_SIC_MAPAACESSOS_H
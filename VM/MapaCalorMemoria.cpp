@@ -0,0 +1,147 @@
+#include "MapaCalorMemoria.h"
+#include <QHBoxLayout>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QToolTip>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+ImagemMapaCalor::ImagemMapaCalor(const MapaAcessos& mapa, QWidget *parent)
+    : QWidget(parent), m_mapa(mapa)
+{
+    setMouseTracking(true);
+}
+
+void ImagemMapaCalor::setImagem(const QImage& imagem, int zoom)
+{
+    m_imagem = imagem;
+    m_zoom = std::max(1, zoom);
+    setFixedSize(m_imagem.size() * m_zoom);
+    update();
+}
+
+void ImagemMapaCalor::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+    painter.drawImage(rect(), m_imagem);
+}
+
+void ImagemMapaCalor::mouseMoveEvent(QMouseEvent *evento)
+{
+    const int x = evento->pos().x() / m_zoom;
+    const int y = evento->pos().y() / m_zoom;
+    const std::size_t linha = static_cast<std::size_t>(y) * LINHAS_POR_FILA + x;
+    if (x < 0 || y < 0 || x >= LINHAS_POR_FILA || linha >= m_mapa.getNumLinhas()) {
+        QToolTip::hideText();
+        return;
+    }
+    const std::size_t inicio = linha << LINHA_ACESSO_BITS;
+    QToolTip::showText(evento->globalPos(),
+                       QString("0x%1 - 0x%2\nleituras: %3 bytes\nescritas: %4 bytes")
+                           .arg(inicio, 5, 16, QChar('0'))
+                           .arg(inicio + TAMANHO_LINHA_ACESSO - 1, 5, 16, QChar('0'))
+                           .arg(m_mapa.leiturasDaLinha(linha))
+                           .arg(m_mapa.escritasDaLinha(linha)),
+                       this);
+}
+
+MapaCalorMemoria::MapaCalorMemoria(const MapaAcessos& mapa, QWidget *parent)
+    : QWidget(parent), m_mapa(mapa)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    QHBoxLayout *controles = new QHBoxLayout();
+    cmbModo = new QComboBox();
+    cmbModo->addItems({"Leituras", "Escritas", "Leituras + escritas"});
+    cmbModo->setCurrentIndex(TODOS);
+    sldZoom = new QSlider(Qt::Horizontal);
+    sldZoom->setRange(1, 16);
+    sldZoom->setValue(4);
+    controles->addWidget(cmbModo);
+    controles->addWidget(new QLabel("Zoom:"));
+    controles->addWidget(sldZoom, 1);
+    layout->addLayout(controles);
+
+    lblResumo = new QLabel();
+    layout->addWidget(lblResumo);
+
+    imagem = new ImagemMapaCalor(m_mapa);
+    areaImagem = new QScrollArea();
+    areaImagem->setWidget(imagem);
+    layout->addWidget(areaImagem, 1);
+
+    connect(cmbModo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int) { atualizar(); });
+    // O zoom só amplia a imagem já calculada
+    connect(sldZoom, &QSlider::valueChanged, this, [this](int zoom) { imagem->setImagem(m_imagem, zoom); });
+
+    atualizar();
+}
+
+void MapaCalorMemoria::atualizarPeriodico()
+{
+    if (m_relogio.isValid() && m_relogio.elapsed() < INTERVALO_MS) {
+        return;
+    }
+    atualizar();
+}
+
+/*
+=========================================================================================
+Recalcula a imagem a partir dos contadores. São poucos milhares de linhas, então a
+imagem inteira é refeita a cada vez.
+=========================================================================================
+*/
+void MapaCalorMemoria::atualizar()
+{
+    m_relogio.start();
+
+    const std::size_t linhas = m_mapa.getNumLinhas();
+    const int modo = cmbModo->currentIndex();
+    std::vector<std::uint64_t> contagens(linhas);
+    std::uint64_t maximo = 0;
+    std::size_t tocadas = 0;
+    for (std::size_t k = 0; k < linhas; ++k) {
+        std::uint64_t c = 0;
+        if (modo != ESCRITAS) c += m_mapa.leiturasDaLinha(k);
+        if (modo != LEITURAS) c += m_mapa.escritasDaLinha(k);
+        contagens[k] = c;
+        maximo = std::max(maximo, c);
+        tocadas += c != 0;
+    }
+
+    const int filas = static_cast<int>((linhas + LINHAS_POR_FILA - 1) / LINHAS_POR_FILA);
+    m_imagem = QImage(LINHAS_POR_FILA, std::max(1, filas), QImage::Format_RGB32);
+    m_imagem.fill(palette().color(QPalette::Window));
+    const double escala = std::log1p(static_cast<double>(maximo));
+    for (std::size_t k = 0; k < linhas; ++k) {
+        const QRgb cor = contagens[k] == 0 ? qRgb(60, 60, 60)
+                                           : corCalor(std::log1p(static_cast<double>(contagens[k])) / escala);
+        m_imagem.setPixel(static_cast<int>(k % LINHAS_POR_FILA), static_cast<int>(k / LINHAS_POR_FILA), cor);
+    }
+    imagem->setImagem(m_imagem, sldZoom->value());
+
+    lblResumo->setText(QString("Linhas acessadas: %1 de %2 (%3 KB); máximo %4 bytes numa linha")
+                           .arg(tocadas)
+                           .arg(linhas)
+                           .arg(tocadas * TAMANHO_LINHA_ACESSO / 1024.0, 0, 'f', 1)
+                           .arg(maximo));
+}
+
+// t em [0, 1]: azul -> ciano -> amarelo -> vermelho
+QRgb MapaCalorMemoria::corCalor(double t)
+{
+    t = std::clamp(t, 0.0, 1.0);
+    if (t < 1.0 / 3) {
+        const double u = t * 3;
+        return qRgb(0, static_cast<int>(255 * u), 255);
+    }
+    if (t < 2.0 / 3) {
+        const double u = (t - 1.0 / 3) * 3;
+        return qRgb(static_cast<int>(255 * u), 255, static_cast<int>(255 * (1 - u)));
+    }
+    const double u = (t - 2.0 / 3) * 3;
+    return qRgb(255, static_cast<int>(255 * (1 - u)), 0);
+}
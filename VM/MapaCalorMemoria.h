@@ -0,0 +1,65 @@
+#ifndef VM_SIC_MAPACALORMEMORIA_H
+#define VM_SIC_MAPACALORMEMORIA_H
+
+#include <QComboBox>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QLabel>
+#include <QScrollArea>
+#include <QSlider>
+#include <QWidget>
+#include "MapaAcessos.h"
+
+// Um pixel por linha de 64 bytes, LINHAS_POR_FILA linhas por fila de pixels
+constexpr int LINHAS_POR_FILA = 64;
+
+// Imagem do mapa ampliada por um fator inteiro (sem suavizar), com o trecho de memória
+// e os contadores do pixel sob o mouse numa dica
+class ImagemMapaCalor : public QWidget
+{
+public:
+    explicit ImagemMapaCalor(const MapaAcessos& mapa, QWidget *parent = nullptr);
+    void setImagem(const QImage& imagem, int zoom);
+
+protected:
+    void paintEvent(QPaintEvent *evento) override;
+    void mouseMoveEvent(QMouseEvent *evento) override;
+
+private:
+    const MapaAcessos& m_mapa;
+    QImage m_imagem;
+    int m_zoom = 1;
+};
+
+// Mapa de calor dos acessos à memória (só na máquina compilada com VM_SIC_MAPA_ACESSOS).
+// A cor de cada linha vai do azul ao vermelho em escala logarítmica até a linha mais
+// acessada; linhas nunca acessadas ficam cinza, o que mostra o conjunto de trabalho.
+class MapaCalorMemoria : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int INTERVALO_MS = 500;
+
+    explicit MapaCalorMemoria(const MapaAcessos& mapa, QWidget *parent = nullptr);
+
+    void atualizar();
+    // Durante a execução: redesenha no máximo a cada INTERVALO_MS
+    void atualizarPeriodico();
+
+private:
+    enum Modo { LEITURAS = 0, ESCRITAS = 1, TODOS = 2 };
+
+    const MapaAcessos& m_mapa;
+    QComboBox *cmbModo;
+    QSlider *sldZoom;
+    QLabel *lblResumo;
+    QScrollArea *areaImagem;
+    ImagemMapaCalor *imagem;
+    QElapsedTimer m_relogio;
+    QImage m_imagem;
+
+    static QRgb corCalor(double t);
+};
+
+#endif //VM_SIC_MAPACALORMEMORIA_H
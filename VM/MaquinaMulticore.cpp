@@ -0,0 +1,109 @@
+#include "MaquinaMulticore.h"
+#include <algorithm>
+#include <barrier>
+#include <thread>
+
+MaquinaMulticore::MaquinaMulticore(std::size_t num_cpus, std::size_t tamanho_memoria) : m_memoria(tamanho_memoria) {
+    m_memoria.tornarCompartilhada();
+    for (std::size_t id = 0; id < num_cpus; ++id) {
+        m_cpus.push_back(std::make_unique<Maquina>(m_memoria, static_cast<std::uint8_t>(id)));
+        m_cpus.back()->setLog(nullptr); // várias threads no mesmo std::cout só embaralham o rastreamento
+    }
+}
+
+void MaquinaMulticore::carregarImagem(std::shared_ptr<const ImagemCompartilhada> imagem) {
+    // a imagem é copiada nas páginas já privadas, sem voltar a compartilhá-las
+    const std::vector<std::shared_ptr<Pagina>>& paginas = imagem->getPaginas();
+    for (std::size_t endereco = 0; endereco < imagem->getTamanho(); ++endereco) {
+        m_memoria.setByteAtomico(endereco, (*paginas[endereco >> PAGINA_BITS])[endereco & PAGINA_MASCARA]);
+    }
+    for (auto& cpu : m_cpus) {
+        cpu->reiniciarEstado();
+        cpu->getCPU().r = Registradores{};
+    }
+}
+
+std::vector<Falha> MaquinaMulticore::executar(std::uint64_t limite_por_cpu) {
+    std::vector<Falha> falhas(m_cpus.size());
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(m_cpus.size());
+        for (std::size_t id = 0; id < m_cpus.size(); ++id) {
+            threads.emplace_back([this, &falhas, id, limite_por_cpu] {
+                falhas[id] = m_cpus[id]->executar(limite_por_cpu);
+            });
+        }
+    } // jthread faz join ao sair do escopo
+    return falhas;
+}
+
+/*
+=========================================================================================
+Execução determinística por quantum. Cada CPU roda, com seus próprios dispositivos,
+agenda e contadores, sobre uma visão privada da memória comum (páginas compartilhadas,
+registro de escritas ligado). Na barreira, uma única thread aplica os registros em
+ordem de CPU e devolve às visões as páginas que elas sujaram; as páginas limpas já
+enxergam a memória comum, que é escrita no lugar. No fim as CPUs voltam à memória comum.
+=========================================================================================
+*/
+std::vector<Falha> MaquinaMulticore::executarDeterministico(std::uint64_t quantum, std::uint64_t limite_por_cpu) {
+    const std::size_t n = m_cpus.size();
+    quantum = std::max<std::uint64_t>(1, quantum);
+
+    std::vector<Memoria> vistas;
+    vistas.reserve(n);
+    for (std::size_t id = 0; id < n; ++id) {
+        vistas.emplace_back(m_memoria.getTamanhoBytes() / 3);
+        vistas.back().copiarPaginasDe(m_memoria); // sem as travas: a visão é de uma CPU só
+        vistas.back().limparPaginasSujas();
+        vistas.back().setRegistroEscritas(true);
+    }
+    for (std::size_t id = 0; id < n; ++id) {
+        m_cpus[id]->setMemoria(vistas[id]);
+    }
+
+    std::vector<Falha> falhas(n, Falha::LIMITE_INSTRUCOES);
+    std::vector<std::uint64_t> restantes(n, limite_por_cpu);
+    bool terminado = n == 0;
+
+    auto sincronizar = [&]() noexcept {
+        bool alguma_ativa = false;
+        for (std::size_t id = 0; id < n; ++id) {
+            Memoria& vista = vistas[id];
+            for (std::uint32_t endereco : vista.getRegistroEscritas()) {
+                m_memoria.setByteAtomico(endereco, vista.getByte(endereco));
+            }
+            vista.limparRegistroEscritas();
+            alguma_ativa |= falhas[id] == Falha::LIMITE_INSTRUCOES && restantes[id] > 0;
+        }
+        for (Memoria& vista : vistas) {
+            vista.restaurarPaginasSujas(m_memoria);
+        }
+        terminado = !alguma_ativa;
+    };
+
+    std::barrier barreira(static_cast<std::ptrdiff_t>(n), sincronizar);
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(n);
+        for (std::size_t id = 0; id < n; ++id) {
+            threads.emplace_back([&, id] {
+                while (!terminado) {
+                    // CPUs paradas só acompanham as barreiras
+                    if (falhas[id] == Falha::LIMITE_INSTRUCOES && restantes[id] > 0) {
+                        std::uint64_t fatia = std::min(quantum, restantes[id]);
+                        std::uint64_t antes = m_cpus[id]->getContadorInstrucoes();
+                        falhas[id] = m_cpus[id]->executar(fatia);
+                        restantes[id] -= m_cpus[id]->getContadorInstrucoes() - antes;
+                    }
+                    barreira.arrive_and_wait();
+                }
+            });
+        }
+    } // jthread faz join ao sair do escopo
+
+    for (auto& cpu : m_cpus) {
+        cpu->setMemoria(m_memoria);
+    }
+    return falhas;
+}
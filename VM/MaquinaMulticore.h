@@ -0,0 +1,37 @@
+#ifndef VM_SIC_MAQUINAMULTICORE_H
+#define VM_SIC_MAQUINAMULTICORE_H
+
+#include "Maquina_melhor.h"
+
+// Várias CPUs (uma Maquina cada, com seus próprios Registradores) sobre uma única Memoria.
+// Cada CPU roda em sua própria thread. Escritas de palavra são atômicas (ver
+// Memoria::escreverPalavraAtomica), e o convidado descobre em qual CPU está com IDCPU.
+class MaquinaMulticore {
+private:
+    Memoria m_memoria;
+    std::vector<std::unique_ptr<Maquina>> m_cpus;
+
+public:
+    MaquinaMulticore(std::size_t num_cpus, std::size_t tamanho_memoria = MEMORIA_TAMANHO);
+
+    // Carrega o programa na memória comum; todas as CPUs começam no PC 0, com o estado de
+    // execução (contadores, agenda, interrupções pendentes) zerado
+    void carregarImagem(std::shared_ptr<const ImagemCompartilhada> imagem);
+
+    // Roda todas as CPUs em paralelo até cada uma parar (ou esgotar seu limite)
+    std::vector<Falha> executar(std::uint64_t limite_por_cpu = std::numeric_limits<std::uint64_t>::max());
+
+    // Modo determinístico: as CPUs rodam em paralelo por 'quantum' instruções sobre uma
+    // visão privada da memória e se encontram em uma barreira. Lá as escritas de cada CPU
+    // são aplicadas na memória comum em ordem de CPU (0, 1, ...), e só então ficam visíveis
+    // para as outras. O resultado é o mesmo em toda repetição.
+    std::vector<Falha> executarDeterministico(std::uint64_t quantum,
+                                              std::uint64_t limite_por_cpu = std::numeric_limits<std::uint64_t>::max());
+
+    std::size_t getNumCPUs() const { return m_cpus.size(); }
+    Maquina& getCPU(std::size_t id) { return *m_cpus[id]; }
+    Memoria& getMemoria() { return m_memoria; }
+    const Memoria& getMemoria() const { return m_memoria; }
+};
+
+#endif //VM_SIC_MAQUINAMULTICORE_H
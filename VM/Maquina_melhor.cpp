@@ -1,7 +1,27 @@
 #include "Maquina_melhor.h"
 #include <stdexcept> 
+#include <algorithm>
+#include <cmath>
 
-Maquina::Maquina(std::size_t tamanho_memoria) : memoria(tamanho_memoria){}
+// Mapa de acessos (bytes por linha de memória física). Sem VM_SIC_MAPA_ACESSOS as
+// contagens somem do código, inclusive os argumentos.
+#ifdef VM_SIC_MAPA_ACESSOS
+#define CONTAR_LEITURA(endereco, bytes) m_mapa_acessos.leitura((endereco), (bytes))
+#define CONTAR_ESCRITA(endereco, bytes) m_mapa_acessos.escrita((endereco), (bytes))
+#else
+#define CONTAR_LEITURA(endereco, bytes) ((void)0)
+#define CONTAR_ESCRITA(endereco, bytes) ((void)0)
+#endif
+
+Maquina::Maquina(std::size_t tamanho_memoria) : m_memoria_propria(tamanho_memoria), memoria(&m_memoria_propria){
+    m_idiomas_recusados.fill(std::numeric_limits<std::size_t>::max());
+}
+
+Maquina::Maquina(Memoria& compartilhada, std::uint8_t id_cpu)
+    : m_memoria_propria(0), memoria(&compartilhada), m_compartilhada(compartilhada.isCompartilhada()) {
+    cpu.id = id_cpu;
+    m_idiomas_recusados.fill(std::numeric_limits<std::size_t>::max());
+}
 
 /*
 =========================================================================================
@@ -15,35 +35,667 @@ void Maquina::carregarPrograma(const std::string& caminhoArquivo) {
         return;
     }
 
+    std::vector<std::uint8_t> imagem((std::istreambuf_iterator<char>(arquivo)), std::istreambuf_iterator<char>());
+    carregarImagem(imagem);
+}
+
+/*
+=========================================================================================
+Carregar uma imagem já em memória a partir do endereço 0 (usado pelo executor em lote).
+=========================================================================================
+*/
+void Maquina::carregarImagem(const std::vector<std::uint8_t>& imagem) {
     std::size_t endereco = 0;
-    int byte;
-    while((byte = arquivo.get()) != EOF) {
-        memoria.setByte(endereco++, static_cast<std::uint8_t>(byte));   
+    for (std::uint8_t byte : imagem) {
+        memoria->setByte(endereco++, byte);
     }
 
-    // início do programa
-    cpu.r.PC = 0;
-    m_running = false; // Garante que não esteja rodando após carregar
+    cpu.r.PC = 0; // início do programa
+    reiniciarEstado(); // não se volta para antes da carga
+}
+
+/*
+=========================================================================================
+Mapear uma imagem compartilhada: as páginas do programa não são copiadas, e as
+instruções já decodificadas pela imagem são reaproveitadas enquanto não forem escritas.
+=========================================================================================
+*/
+void Maquina::carregarImagem(std::shared_ptr<const ImagemCompartilhada> imagem) {
+    memoria->carregarImagem(std::move(imagem));
+
+    cpu.r.PC = 0; // início do programa
+    reiniciarEstado(); // não se volta para antes da carga
+}
+
+/*
+=========================================================================================
+Capturar o estado atual como baseline. As marcas de página suja são zeradas para que
+reset_to() só precise restaurar o que for escrito depois deste ponto.
+=========================================================================================
+*/
+EstadoBase Maquina::criarBaseline() {
+    memoria->limparPaginasSujas();
+    memoria->compartilharPaginas(); // as próximas escritas não podem alterar o baseline
+    return EstadoBase{cpu.r, *memoria, m_tabela_paginas, m_num_paginas, getTemporizador(),
+                      m_pendentes, m_icode_pendente};
+}
+
+/*
+=========================================================================================
+Restaurar o baseline sem reconstruir a memória: só as páginas sujas são copiadas.
+=========================================================================================
+*/
+void Maquina::reset_to(const EstadoBase& baseline) {
+    memoria->restaurarPaginasSujas(baseline.memoria);
+    cpu.r = baseline.regs;
+    reiniciarEstado(); // o histórico era da execução que o baseline descartou
+
+    // o relógio voltou a zero: o temporizador é reagendado com o que faltava na captura
+    setTabelaPaginas(baseline.tabela_paginas, baseline.num_paginas);
+    m_pendentes = baseline.pendentes;
+    m_icode_pendente = baseline.icode_pendente;
+    iniciarTemporizador(static_cast<std::uint32_t>(baseline.temporizador));
+}
+
+/*
+=========================================================================================
+Estado de execução de um programa recém-carregado ou recém-restaurado (a memória e os
+registradores ficam por conta de quem chama). O contador de instruções volta a zero,
+então a agenda, cujos prazos eram relativos a ele, é esvaziada; o histórico de passos
+descrevia outra memória e também é descartado.
+=========================================================================================
+*/
+void Maquina::reiniciarEstado() {
+    m_running = false;
+    m_instrucoes = 0;
+    m_tempo_ocioso = 0;
+    m_agenda.limpar();
+    m_pendentes = 0;
+    m_evento_temporizador = 0;
+    setTabelaPaginas(0, 0);
+    m_idiomas_recusados.fill(std::numeric_limits<std::size_t>::max()); // programa novo
+    if (m_historico) {
+        m_historico->limpar();
+    }
+    m_falha = Falha::NENHUMA;
+    m_erro.clear();
 }
 
 /*
 =========================================================================================
 Começar o loop de execução da máquina. Agora controlado pelo flag m_running.
+Para após 'limite_instrucoes' instruções; o motivo da parada é retornado.
 =========================================================================================
 */
-void Maquina::executar() {
+Falha Maquina::executar(std::uint64_t limite_instrucoes) {
     // Inicializa o flag de execução
     m_running = true; 
+    m_falha = Falha::NENHUMA;
+    m_erro.clear();
+    const std::uint64_t inicio = m_instrucoes;
+    m_fim_orcamento = limite_instrucoes > std::numeric_limits<std::uint64_t>::max() - inicio
+                          ? std::numeric_limits<std::uint64_t>::max() : inicio + limite_instrucoes;
     
     while(m_running){ // Loop controlado pelo flag
+        if (m_instrucoes - inicio >= limite_instrucoes) {
+            m_falha = Falha::LIMITE_INSTRUCOES;
+            m_running = false;
+            break;
+        }
+        if (m_parada_solicitada.load(std::memory_order_relaxed)) {
+            m_parada_solicitada.store(false, std::memory_order_relaxed);
+            m_falha = Falha::INTERROMPIDA;
+            m_running = false;
+            break;
+        }
         try {
             passo();
             // A condição de parada (PC fora dos limites) é verificada dentro de passo()
+            if (m_falha == Falha::AGUARDANDO_DISPOSITIVO) {
+                m_agenda.descartarCancelados(); // um evento cancelado não acorda ninguém
+                if (!m_agenda.vazia()) {
+                    // ociosa: o tempo simulado salta até o próximo evento em vez de dormir
+                    // ou devolver a espera; nenhuma instrução foi executada, então
+                    // m_instrucoes não muda
+                    const std::uint64_t agora = tempoSimulado();
+                    m_tempo_ocioso += std::max(agora, m_agenda.proximoPrazo()) - agora;
+                    m_falha = Falha::NENHUMA;
+                    m_running = true;
+                } else if (m_espera_no_host) {
+                    esperarDispositivo(m_dispositivo_aguardado);
+                    m_falha = Falha::NENHUMA;
+                    m_running = true;
+                }
+            }
         } catch (const std::exception& e) {
+            // interrupções de programa habilitadas já foram entregues por passo()
             std::cerr << "Erro fatal durante a execucao: " << e.what() << std::endl;
+            m_falha = Falha::EXCECAO;
+            m_erro = e.what();
             m_running = false;
         }
     }
+    m_fim_orcamento = 0;
+    // uma fatia que só esgotou o limite continua depois: a saída fica no buffer até a máquina parar
+    if (m_falha != Falha::LIMITE_INSTRUCOES) {
+        descarregarDispositivos();
+    }
+    return m_falha;
+}
+
+/*
+=========================================================================================
+Interrupções. A CPU salva SW, PC e registradores na área da classe e carrega a nova SW
+e o novo PC da mesma área; o núcleo convidado retorna (ou troca de tarefa) com LPS.
+=========================================================================================
+*/
+std::uint32_t Maquina::lerPalavraMemoria(std::size_t endereco_byte) {
+    CONTAR_LEITURA(endereco_byte, 3);
+    if (m_compartilhada) {
+        return memoria->lerPalavraAtomica(endereco_byte);
+    }
+    return (memoria->getByte(endereco_byte) << 16) | (memoria->getByte(endereco_byte + 1) << 8) |
+           memoria->getByte(endereco_byte + 2);
+}
+
+void Maquina::escreverPalavraMemoria(std::size_t endereco_byte, std::uint32_t valor) {
+    ++m_escritas;
+    CONTAR_ESCRITA(endereco_byte, 3);
+    if (m_compartilhada) {
+        memoria->escreverPalavraAtomica(endereco_byte, valor);
+        return;
+    }
+    memoria->setByte(endereco_byte, (valor >> 16) & 0xFF);
+    memoria->setByte(endereco_byte + 1, (valor >> 8) & 0xFF);
+    memoria->setByte(endereco_byte + 2, valor & 0xFF);
+}
+
+void Maquina::interromper(ClasseInterrupcao classe, std::uint8_t icode) {
+    std::size_t area = AREA_INTERRUPCOES + static_cast<std::size_t>(classe) * TAMANHO_AREA_INTERRUPCAO;
+    cpu.r.icode = icode;
+
+    const std::int32_t salvos[] = {cpu.r.PC, cpu.r.A, cpu.r.X, cpu.r.L, cpu.r.B, cpu.r.S, cpu.r.T};
+    escreverPalavraMemoria(area + 6, montarPalavraStatus(cpu.r, cpu.id));
+    for (std::size_t k = 0; k < 7; ++k) {
+        escreverPalavraMemoria(area + 9 + 3 * k, salvos[k] & 0xFFFFFF);
+    }
+    std::uint64_t f = empacotarFlutuante(cpu.r.F);
+    escreverPalavraMemoria(area + 30, static_cast<std::uint32_t>(f >> 24));
+    escreverPalavraMemoria(area + 33, static_cast<std::uint32_t>(f & 0xFFFFFF));
+
+    carregarPalavraStatus(cpu.r, lerPalavraMemoria(area));
+    cpu.r.PC = lerPalavraMemoria(area + 3);
+    if (m_log) *m_log << "[INT] classe " << static_cast<int>(classe) + 1 << ", ICODE " << (int)icode
+                      << " - PC = " << cpu.r.PC << "\n";
+}
+
+// Carrega SW, PC, registradores e F a partir de 'endereco_byte' (LPS). Os registradores
+// foram guardados em 24 bits; o sinal é estendido na volta.
+void Maquina::carregarStatus(std::size_t endereco_byte) {
+    carregarPalavraStatus(cpu.r, lerPalavraMemoria(endereco_byte));
+    cpu.r.PC = lerPalavraMemoria(endereco_byte + 3);
+
+    std::int32_t* destinos[] = {&cpu.r.A, &cpu.r.X, &cpu.r.L, &cpu.r.B, &cpu.r.S, &cpu.r.T};
+    for (std::size_t k = 0; k < 6; ++k) {
+        std::uint32_t valor = lerPalavraMemoria(endereco_byte + 6 + 3 * k);
+        *destinos[k] = static_cast<std::int32_t>(valor << 8) >> 8;
+    }
+    std::uint64_t f = (std::uint64_t{lerPalavraMemoria(endereco_byte + 24)} << 24) | lerPalavraMemoria(endereco_byte + 27);
+    cpu.r.F = desempacotarFlutuante(f);
+
+    // a nova máscara pode liberar interrupções que estavam esperando
+    if (m_pendentes) {
+        agendarEvento(0, [this] { entregarPendentes(); });
+    }
+}
+
+void Maquina::solicitarInterrupcao(ClasseInterrupcao classe, std::uint8_t icode) {
+    std::size_t indice = static_cast<std::size_t>(classe);
+    m_pendentes |= MASCARA_SVC >> indice;
+    m_icode_pendente[indice] = icode;
+    entregarPendentes();
+}
+
+// Entrega a pendente habilitada de maior prioridade; as demais esperam a próxima LPS
+void Maquina::entregarPendentes() {
+    for (std::size_t indice = 0; indice < m_icode_pendente.size(); ++indice) {
+        std::uint8_t bit = MASCARA_SVC >> indice;
+        if ((m_pendentes & bit) && (cpu.r.mascara & bit)) {
+            m_pendentes &= ~bit;
+            interromper(static_cast<ClasseInterrupcao>(indice), m_icode_pendente[indice]);
+            return;
+        }
+    }
+}
+
+// Temporizador de intervalo (STI), contado no tempo simulado
+void Maquina::iniciarTemporizador(std::uint32_t intervalo) {
+    if (m_evento_temporizador) {
+        cancelarEvento(m_evento_temporizador);
+        m_evento_temporizador = 0;
+    }
+    if (intervalo == 0) {
+        return;
+    }
+    m_prazo_temporizador = tempoSimulado() + intervalo;
+    m_evento_temporizador = agendarEvento(intervalo, [this] {
+        m_evento_temporizador = 0;
+        solicitarInterrupcao(ClasseInterrupcao::TEMPORIZADOR);
+    });
+}
+
+std::uint64_t Maquina::getTemporizador() const {
+    if (!m_evento_temporizador) {
+        return 0;
+    }
+    return m_prazo_temporizador - std::min(tempoSimulado(), m_prazo_temporizador);
+}
+
+/*
+=========================================================================================
+Memória virtual. Na falta da TLB a entrada da tabela é lida da memória física; faltas
+viram interrupções de programa com o endereço virtual guardado na área da classe.
+=========================================================================================
+*/
+std::size_t Maquina::preencherTLB(std::size_t endereco_virtual, bool escrita) {
+    std::size_t pagina = endereco_virtual >> PAGINA_BITS;
+    auto falta = [&](std::uint8_t icode, const char* mensagem) {
+        std::size_t area = AREA_INTERRUPCOES + static_cast<std::size_t>(ClasseInterrupcao::PROGRAMA) * TAMANHO_AREA_INTERRUPCAO;
+        escreverPalavraMemoria(area + ENDERECO_FALTA, endereco_virtual & 0xFFFFFF);
+        return InterrupcaoPrograma(icode, mensagem);
+    };
+
+    if (pagina >= m_num_paginas) {
+        throw falta(InterrupcaoPrograma::FALTA_PAGINA, "Endereco virtual fora da tabela de paginas.");
+    }
+    std::size_t endereco_entrada = m_tabela_paginas + 3 * pagina;
+    std::uint32_t entrada = lerPalavraMemoria(endereco_entrada);
+    if (!(entrada & PAGINA_VALIDA)) {
+        throw falta(InterrupcaoPrograma::FALTA_PAGINA, "Falta de pagina.");
+    }
+    if (escrita && !(entrada & PAGINA_GRAVAVEL)) {
+        throw falta(InterrupcaoPrograma::PROTECAO_PAGINA, "Escrita em pagina protegida.");
+    }
+    std::size_t fisico = std::size_t{entrada & PAGINA_QUADRO} << PAGINA_BITS;
+    if (fisico + TAMANHO_PAGINA > memoria->getTamanhoBytes()) {
+        throw falta(InterrupcaoPrograma::ENDERECO_INVALIDO, "Quadro fisico fora da memoria.");
+    }
+
+    // bits de uso para o algoritmo de substituição do núcleo convidado
+    std::uint32_t marcada = entrada | PAGINA_REFERENCIADA | (escrita ? PAGINA_MODIFICADA : 0);
+    if (marcada != entrada) {
+        escreverPalavraMemoria(endereco_entrada, marcada);
+    }
+
+    EntradaTLB nova{pagina, static_cast<std::ptrdiff_t>(fisico) - static_cast<std::ptrdiff_t>(pagina << PAGINA_BITS)};
+    m_tlb_leitura[pagina % TLB_ENTRADAS] = nova;
+    if (escrita) {
+        m_tlb_escrita[pagina % TLB_ENTRADAS] = nova;
+    }
+    return endereco_virtual + nova.deslocamento;
+}
+
+void Maquina::limparTLB() {
+    m_tlb_leitura.fill(EntradaTLB{});
+    m_tlb_escrita.fill(EntradaTLB{});
+}
+
+void Maquina::setTabelaPaginas(std::size_t endereco_tabela, std::size_t num_paginas) {
+    m_tabela_paginas = endereco_tabela;
+    m_num_paginas = num_paginas;
+    limparTLB();
+}
+
+// Busca byte a byte: só os bytes que a instrução usa são traduzidos (ela pode cruzar páginas)
+InstrucaoDecodificada Maquina::buscarInstrucaoVirtual(std::size_t pc_virtual) {
+    auto byteVirtual = [this](std::size_t endereco) -> std::uint8_t {
+        std::size_t fisico = traduzir(endereco, false);
+        return m_compartilhada ? memoria->getByteAtomico(fisico) : memoria->getByte(fisico);
+    };
+
+    std::uint8_t b1 = byteVirtual(pc_virtual), b2 = 0, b3 = 0, b4 = 0;
+    Formato formato = formatoDoOpcode(b1 & 0xFC);
+    if (formato != Formato::F1) {
+        b2 = byteVirtual(pc_virtual + 1);
+    }
+    if (formato == Formato::F3) {
+        b3 = byteVirtual(pc_virtual + 2);
+        if (b2 & 0x10) { // e = 1: formato 4
+            b4 = byteVirtual(pc_virtual + 3);
+        }
+    }
+    return decodificar(b1, b2, b3, b4);
+}
+
+/*
+=========================================================================================
+Chamadas ao hospedeiro (HCALL). Na memória plana os blocos vão direto para a Memoria
+(memmove/memset do hospedeiro); com paginação ou memória compartilhada, byte a byte.
+=========================================================================================
+*/
+bool Maquina::acessoDiretoHost(std::size_t inicio, std::size_t quantidade) const {
+    if (m_traduzir || m_compartilhada) {
+        return false;
+    }
+    if (inicio + quantidade > memoria->getTamanhoBytes()) {
+        throw InterrupcaoPrograma(InterrupcaoPrograma::ENDERECO_INVALIDO, "HCALL fora dos limites da memoria.");
+    }
+    return true;
+}
+
+// Confere a faixa inteira antes de a HCALL tocar em qualquer byte: sem paginação contra o
+// tamanho da memória; com paginação, traduzindo uma vez cada página, como fazem as cargas e
+// os armazenamentos (a falta sai com o endereço virtual da primeira página recusada).
+void Maquina::verificarFaixaHost(std::size_t inicio, std::size_t quantidade, bool escrita) {
+    if (quantidade == 0) {
+        return;
+    }
+    if (!m_traduzir) {
+        if (inicio + quantidade > memoria->getTamanhoBytes()) {
+            throw InterrupcaoPrograma(InterrupcaoPrograma::ENDERECO_INVALIDO, "HCALL fora dos limites da memoria.");
+        }
+        return;
+    }
+    // páginas além da tabela faltam já na primeira: o laço não passa de m_num_paginas voltas
+    for (std::size_t endereco = inicio; endereco < inicio + quantidade; endereco = (endereco | PAGINA_MASCARA) + 1) {
+        traduzir(endereco, escrita);
+    }
+}
+
+std::uint8_t Maquina::lerByteHost(std::size_t endereco) {
+    std::size_t fisico = m_traduzir ? traduzir(endereco, false) : endereco;
+    if (fisico >= memoria->getTamanhoBytes()) {
+        throw InterrupcaoPrograma(InterrupcaoPrograma::ENDERECO_INVALIDO, "HCALL fora dos limites da memoria.");
+    }
+    CONTAR_LEITURA(fisico, 1);
+    return m_compartilhada ? memoria->getByteAtomico(fisico) : memoria->getByte(fisico);
+}
+
+void Maquina::escreverByteHost(std::size_t endereco, std::uint8_t valor) {
+    std::size_t fisico = m_traduzir ? traduzir(endereco, true) : endereco;
+    if (fisico >= memoria->getTamanhoBytes()) {
+        throw InterrupcaoPrograma(InterrupcaoPrograma::ENDERECO_INVALIDO, "HCALL fora dos limites da memoria.");
+    }
+    CONTAR_ESCRITA(fisico, 1);
+    if (m_compartilhada) {
+        memoria->setByteAtomico(fisico, valor);
+    } else {
+        memoria->setByte(fisico, valor);
+    }
+}
+
+void Maquina::chamadaHost(std::uint8_t numero) {
+    const std::size_t destino = static_cast<std::uint32_t>(cpu.r.S) & 0xFFFFFF;
+    const std::size_t origem = static_cast<std::uint32_t>(cpu.r.X) & 0xFFFFFF;
+    const std::size_t tamanho = static_cast<std::uint32_t>(cpu.r.T) & 0xFFFFFF;
+
+    switch (numero) {
+        case HCALL_CONSULTA: {
+            cpu.r.A = (1 << HCALL_MOVER) | (1 << HCALL_PREENCHER) | (1 << HCALL_COMPARAR) | (1 << HCALL_ORDENAR);
+            break;
+        }
+        case HCALL_MOVER: {
+            ++m_escritas;
+            if (acessoDiretoHost(origem, tamanho) && acessoDiretoHost(destino, tamanho)) {
+                CONTAR_LEITURA(origem, tamanho);
+                CONTAR_ESCRITA(destino, tamanho);
+                std::vector<std::uint8_t> bytes = memoria->getBytes(origem, tamanho);
+                memoria->escreverBytes(destino, bytes.data(), tamanho);
+            } else if (destino <= origem) {
+                for (std::size_t k = 0; k < tamanho; ++k) {
+                    escreverByteHost(destino + k, lerByteHost(origem + k));
+                }
+            } else { // sobreposição com o destino adiante: de trás para frente
+                for (std::size_t k = tamanho; k-- > 0;) {
+                    escreverByteHost(destino + k, lerByteHost(origem + k));
+                }
+            }
+            break;
+        }
+        case HCALL_PREENCHER: {
+            ++m_escritas;
+            std::uint8_t valor = cpu.r.A & 0xFF;
+            if (acessoDiretoHost(destino, tamanho)) {
+                CONTAR_ESCRITA(destino, tamanho);
+                memoria->preencherBytes(destino, valor, tamanho);
+            } else {
+                for (std::size_t k = 0; k < tamanho; ++k) {
+                    escreverByteHost(destino + k, valor);
+                }
+            }
+            break;
+        }
+        case HCALL_COMPARAR: {
+            std::int32_t diferenca = 0;
+            for (std::size_t k = 0;; ++k) {
+                std::uint8_t b1 = lerByteHost(destino + k);
+                std::uint8_t b2 = lerByteHost(origem + k);
+                diferenca = static_cast<std::int32_t>(b1) - b2;
+                if (diferenca != 0 || b1 == 0) {
+                    break;
+                }
+            }
+            cpu.r.A = diferenca;
+            cpu.r.SW = diferenca < 0 ? SMALLER : (diferenca == 0 ? EQUAL : BIGGER);
+            break;
+        }
+        case HCALL_ORDENAR: {
+            ++m_escritas;
+            // 'tamanho' vem do convidado: a faixa precisa existir (e aceitar escrita) antes de
+            // alocar o vetor, que assim não passa do que o convidado enxerga
+            verificarFaixaHost(destino, 3 * tamanho, true);
+            std::vector<std::uint8_t> bytes(3 * tamanho);
+            bool direto = acessoDiretoHost(destino, bytes.size());
+            if (direto) {
+                CONTAR_LEITURA(destino, bytes.size());
+                memoria->copiarBytes(destino, bytes.size(), bytes.data());
+            } else {
+                for (std::size_t k = 0; k < bytes.size(); ++k) {
+                    bytes[k] = lerByteHost(destino + k);
+                }
+            }
+
+            std::vector<std::int32_t> palavras(tamanho);
+            for (std::size_t k = 0; k < tamanho; ++k) {
+                std::uint32_t valor = (bytes[3 * k] << 16) | (bytes[3 * k + 1] << 8) | bytes[3 * k + 2];
+                palavras[k] = static_cast<std::int32_t>(valor << 8) >> 8;
+            }
+            std::sort(palavras.begin(), palavras.end());
+            for (std::size_t k = 0; k < tamanho; ++k) {
+                bytes[3 * k] = (palavras[k] >> 16) & 0xFF;
+                bytes[3 * k + 1] = (palavras[k] >> 8) & 0xFF;
+                bytes[3 * k + 2] = palavras[k] & 0xFF;
+            }
+
+            if (direto) {
+                CONTAR_ESCRITA(destino, bytes.size());
+                memoria->escreverBytes(destino, bytes.data(), bytes.size());
+            } else {
+                for (std::size_t k = 0; k < bytes.size(); ++k) {
+                    escreverByteHost(destino + k, bytes[k]);
+                }
+            }
+            break;
+        }
+        default:
+            throw InterrupcaoPrograma(InterrupcaoPrograma::INSTRUCAO_ILEGAL, "HCALL desconhecida.");
+    }
+}
+
+/*
+=========================================================================================
+Reconhecimento de laços de bytes. O laço é executado em bloco sobre a Memoria e os
+registradores ficam como ficariam ao fim das iterações feitas. Se o orçamento de
+executar() ou o próximo evento da agenda vier antes do fim, só parte das iterações é
+feita e o PC volta para o início do laço.
+=========================================================================================
+*/
+InstrucaoDecodificada Maquina::decodificarEm(std::size_t endereco) const {
+    if (const InstrucaoDecodificada* cache = memoria->decodificadaCompartilhada(endereco)) {
+        return *cache;
+    }
+    return decodificar(memoria->getByte(endereco), memoria->getByte(endereco + 1),
+                       memoria->getByte(endereco + 2), memoria->getByte(endereco + 3));
+}
+
+// Endereço alvo sem o índice, como em passo() ('pc_depois' = PC após a instrução)
+static std::uint32_t enderecoSemIndice(const InstrucaoDecodificada& inst, std::size_t pc_depois, std::int32_t base) {
+    if (inst.formato == Formato::F4) return inst.disp;
+    if (inst.p) return static_cast<std::uint32_t>(pc_depois + inst.disp);
+    if (inst.b) return static_cast<std::uint32_t>(base + inst.disp);
+    return inst.disp;
+}
+
+bool Maquina::acelerarLacoDeBytes(const InstrucaoDecodificada& primeira, std::size_t pc, std::uint32_t alvo) {
+    if (m_log || m_rastro || m_traduzir || m_compartilhada || m_fim_orcamento == 0 ||
+        m_idiomas_recusados[pc % IDIOMAS_RECUSADOS] == pc) {
+        return false;
+    }
+    auto recusar = [&] {
+        m_idiomas_recusados[pc % IDIOMAS_RECUSADOS] = pc;
+        return false;
+    };
+    auto ehF3F4 = [](const InstrucaoDecodificada& inst) {
+        return inst.formato == Formato::F3 || inst.formato == Formato::F4;
+    };
+
+    // forma do laço: [LDCH m,X] STCH m,X / TIXR r / JLT início
+    const bool copia = primeira.opcode == 0x50;
+    std::size_t endereco = pc + primeira.tamanho;
+    InstrucaoDecodificada stch = primeira;
+    if (copia) {
+        stch = decodificarEm(endereco);
+        if (stch.opcode != 0x54 || !ehF3F4(stch) || !stch.x) return recusar();
+        endereco += stch.tamanho;
+    }
+    std::uint32_t base_destino = enderecoSemIndice(stch, endereco, cpu.r.B);
+
+    InstrucaoDecodificada tixr = decodificarEm(endereco);
+    if (tixr.opcode != 0xB8 || tixr.formato != Formato::F2 || tixr.r1 < RegID::L || tixr.r1 > RegID::T) {
+        return recusar();
+    }
+    endereco += tixr.tamanho;
+
+    InstrucaoDecodificada jlt = decodificarEm(endereco);
+    if (jlt.opcode != 0x38 || !ehF3F4(jlt) || jlt.x) return recusar();
+    endereco += jlt.tamanho;
+    if (enderecoSemIndice(jlt, endereco, cpu.r.B) != pc) return recusar();
+    const std::size_t fim_laco = endereco;
+
+    // iterações: a primeira sempre acontece; as demais enquanto X + 1 < r
+    const std::int64_t x0 = cpu.r.X;
+    const std::int64_t limite = getRegistradorPorNumero(tixr.r1);
+    if (x0 < 0 || limite - x0 < 2) return false;
+    std::uint64_t iteracoes = static_cast<std::uint64_t>(limite - x0);
+
+    const std::uint64_t por_iteracao = copia ? 4 : 3;
+    const std::uint64_t antes = m_instrucoes - 1; // a instrução atual já foi contada
+    const std::uint64_t prazo = m_agenda.proximoPrazo(); // no tempo simulado
+    const std::uint64_t teto = std::min(m_fim_orcamento, prazo - std::min(prazo, m_tempo_ocioso));
+    if (teto <= antes) return false;
+    iteracoes = std::min(iteracoes, (teto - antes) / por_iteracao);
+    if (iteracoes < 2) return false;
+
+    // faixas dentro da memória, sem sobreposição que mude o resultado de um memmove
+    // e sem escrever sobre o próprio laço
+    const std::size_t tamanho = memoria->getTamanhoBytes();
+    const std::size_t destino = std::size_t{base_destino} + x0;
+    const std::size_t origem = copia ? std::size_t{alvo} : 0;
+    if (destino + iteracoes > tamanho || (copia && origem + iteracoes > tamanho)) return false;
+    if (copia && destino > origem && destino < origem + iteracoes) return false;
+    if (destino < fim_laco && pc < destino + iteracoes) return false;
+
+    ++m_escritas;
+    CONTAR_ESCRITA(destino, iteracoes);
+    if (copia) {
+        CONTAR_LEITURA(origem, iteracoes);
+        std::vector<std::uint8_t> bytes = memoria->getBytes(origem, iteracoes);
+        memoria->escreverBytes(destino, bytes.data(), iteracoes);
+        cpu.r.A = (cpu.r.A & 0xFFFF00) | bytes.back();
+    } else {
+        memoria->preencherBytes(destino, cpu.r.A & 0xFF, iteracoes);
+    }
+    cpu.r.X = static_cast<std::int32_t>(x0 + iteracoes);
+    m_instrucoes = antes + por_iteracao * iteracoes;
+
+    if (cpu.r.X < limite) { // parou antes do fim: volta ao início do laço
+        cpu.r.SW = SMALLER;
+        cpu.r.PC = pc;
+    } else {
+        cpu.r.SW = cpu.r.X == limite ? EQUAL : BIGGER;
+        cpu.r.PC = fim_laco;
+    }
+    return true;
+}
+
+void Maquina::exigirSupervisor(const char* instrucao) const {
+    if (cpu.r.modo == 0) {
+        throw InterrupcaoPrograma(InterrupcaoPrograma::INSTRUCAO_PRIVILEGIADA,
+                                  std::string(instrucao) + " em modo usuario.");
+    }
+}
+
+/*
+=========================================================================================
+Dispositivos de E/S.
+=========================================================================================
+*/
+Dispositivo& Maquina::dispositivo(std::uint8_t numero) {
+    if (!m_dispositivos[numero]) {
+        std::cerr << "Dispositivo inexistente: 0x" << std::hex << (int)numero << std::dec << std::endl;
+        throw std::runtime_error("Tentativa de acessar dispositivo inexistente.");
+    }
+    return *m_dispositivos[numero];
+}
+
+// A instrução não é executada: a máquina para com o PC nela, para ser repetida depois
+void Maquina::aguardarDispositivo(std::size_t pc_instrucao, std::uint8_t numero) {
+    cpu.r.PC = static_cast<std::int32_t>(pc_instrucao);
+    --m_instrucoes;
+    m_dispositivo_aguardado = numero;
+    m_falha = Falha::AGUARDANDO_DISPOSITIVO;
+    m_running = false;
+}
+
+// Um TD ocupado no mesmo PC, poucas instruções depois do anterior e sem nenhuma escrita
+// no meio, é um laço de espera: repetido algumas vezes, o convidado é estacionado.
+bool Maquina::detectarEsperaAtiva(std::size_t pc_instrucao) {
+    bool mesmo_laco = pc_instrucao == m_td_pc &&
+                      m_instrucoes - m_td_instrucao <= LACO_ESPERA_MAX_INSTRUCOES &&
+                      m_escritas == m_td_escritas;
+    m_td_repeticoes = mesmo_laco ? m_td_repeticoes + 1 : 0;
+    m_td_pc = pc_instrucao;
+    m_td_instrucao = m_instrucoes;
+    m_td_escritas = m_escritas;
+
+    if (m_td_repeticoes >= LACO_ESPERA_REPETICOES) {
+        m_td_repeticoes = 0;
+        return true;
+    }
+    return false;
+}
+
+// Dorme até o dispositivo avisar que pode estar pronto (setAvisoPronto) em vez de girar
+// no laço do convidado. O aviso fica instalado só durante a espera.
+void Maquina::esperarDispositivo(std::uint8_t numero) {
+    descarregarDispositivos(); // o convidado pode estar esperando resposta ao que escreveu
+    Dispositivo& d = dispositivo(numero);
+    d.setAvisoPronto([this] {
+        { std::lock_guard<std::mutex> trava(m_mtx_espera); } // quem espera já testou ou já dorme
+        m_cv_espera.notify_all();
+    });
+    {
+        // um pedido de parada também acorda a espera; executar() o atende na volta do laço
+        std::unique_lock<std::mutex> trava(m_mtx_espera);
+        m_cv_espera.wait(trava, [&] { return d.pronto() || m_parada_solicitada.load(std::memory_order_relaxed); });
+    }
+    d.setAvisoPronto(nullptr);
+}
+
+void Maquina::descarregarDispositivos() {
+    for (const auto& d : m_dispositivos) {
+        if (d) d->descarregar();
+    }
 }
 
 /*
@@ -69,25 +721,87 @@ std::int32_t& Maquina::getRegistradorPorNumero(std::uint8_t num) {
 
 /*
 =========================================================================================
-Iniciar o passo da execução da instrução atual.
+Um passo. Uma interrupção de programa com a classe habilitada é entregue aqui, para
+executar() e para quem chama passo() direto (GUI, escalonadores): o núcleo convidado a
+recebe com o PC na instrução que falhou. Com o histórico ligado, tudo o que o passo
+mudar, entrega incluída ou mesmo terminando em exceção, vira uma entrada dele.
 =========================================================================================
 */
 void Maquina::passo() {
+    const bool historico = m_historico && !m_compartilhada;
+    if (historico) {
+        m_historico->iniciarPasso(cpu.r, m_instrucoes, *memoria);
+    }
+    try {
+        executarPasso();
+    } catch (const InterrupcaoPrograma& programa) {
+        if (!(cpu.r.mascara & MASCARA_PROGRAMA)) {
+            if (historico) {
+                m_historico->concluirPasso(cpu.r, m_instrucoes, *memoria);
+            }
+            throw;
+        }
+        cpu.r.PC = m_pc_instrucao;
+        interromper(ClasseInterrupcao::PROGRAMA, programa.icode);
+    } catch (...) {
+        if (historico) {
+            m_historico->concluirPasso(cpu.r, m_instrucoes, *memoria);
+        }
+        throw;
+    }
+    if (historico) {
+        m_historico->concluirPasso(cpu.r, m_instrucoes, *memoria);
+    }
+}
+
+std::size_t Maquina::voltarPassos(std::size_t n) {
+    if (!m_historico) {
+        return 0;
+    }
+    const std::size_t desfeitos = m_historico->voltar(n, cpu.r, m_instrucoes, *memoria);
+    limparTLB(); // a tabela de páginas na memória pode ter voltado junto
+    m_running = false;
+    m_falha = Falha::NENHUMA;
+    m_erro.clear();
+    return desfeitos;
+}
+
+/*
+=========================================================================================
+Iniciar o passo da execução da instrução atual.
+=========================================================================================
+*/
+void Maquina::executarPasso() {
     // Fornece um endereço do byte na memória
     auto lerByte = [this](std::size_t endereco_byte) -> std::uint8_t {
-        const std::vector<std::uint8_t>& m_bytes = memoria.getMBytes();
-        if (endereco_byte < m_bytes.size()) {
-            return m_bytes[endereco_byte];
+        if (m_compartilhada) {
+            return memoria->getByteAtomico(endereco_byte);
         }
-        return 0; // Retorna 0 se fora dos limites
+        return memoria->getByte(endereco_byte); // Retorna 0 se fora dos limites
     };
 
     // Ler uma palavra (3 bytes) da memória a partir de um endereço de byte
     auto lerPalavra = [this, &lerByte](std::size_t endereco_byte) -> std::uint32_t {
-        if (endereco_byte + 2 >= memoria.getTamanhoBytes()) {
+        if (m_traduzir) {
+            if ((endereco_byte & PAGINA_MASCARA) > TAMANHO_PAGINA - 3) { // a palavra cruza páginas
+                const std::size_t fisicos[3] = {traduzir(endereco_byte, false), traduzir(endereco_byte + 1, false),
+                                                traduzir(endereco_byte + 2, false)};
+                CONTAR_LEITURA(fisicos[0], 1);
+                CONTAR_LEITURA(fisicos[1], 1);
+                CONTAR_LEITURA(fisicos[2], 1);
+                return (lerByte(fisicos[0]) << 16) | (lerByte(fisicos[1]) << 8) | lerByte(fisicos[2]);
+            }
+            endereco_byte = traduzir(endereco_byte, false);
+        }
+        if (endereco_byte + 2 >= memoria->getTamanhoBytes()) {
             std::cerr << "ERRO: Tentativa de ler palavra fora dos limites da memória em 0x" << std::hex << endereco_byte << std::dec << std::endl;
             return 0;
         }
+        CONTAR_LEITURA(endereco_byte, 3);
+
+        if (m_compartilhada) {
+            return memoria->lerPalavraAtomica(endereco_byte);
+        }
 
         std::uint8_t b1 = lerByte(endereco_byte);
         std::uint8_t b2 = lerByte(endereco_byte + 1);
@@ -95,42 +809,138 @@ void Maquina::passo() {
         return (b1 << 16) | (b2 << 8) | b3;
     };
 
+    // Gravar bytes cujos endereços físicos já foram todos traduzidos (as faltas, se houver,
+    // saíram antes do primeiro byte escrito)
+    auto escreverTraduzidos = [this](const std::size_t* fisicos, const std::uint8_t* bytes, std::size_t quantidade) {
+        ++m_escritas;
+        for (std::size_t k = 0; k < quantidade; ++k) {
+            CONTAR_ESCRITA(fisicos[k], 1);
+            if (m_compartilhada) {
+                memoria->setByteAtomico(fisicos[k], bytes[k]);
+            } else {
+                memoria->setByte(fisicos[k], bytes[k]);
+            }
+        }
+    };
+
     // Escrever uma palavra (3 bytes) na memória a partir de um endereço de byte
-    auto escreverPalavra = [this](std::size_t endereco_byte, std::uint32_t valor) {
-        memoria.setByte(endereco_byte, (valor >> 16) & 0xFF);
-        memoria.setByte(endereco_byte + 1, (valor >> 8) & 0xFF);
-        memoria.setByte(endereco_byte + 2, valor & 0xFF);
+    auto escreverPalavra = [&](std::size_t endereco_byte, std::uint32_t valor) {
+        if (m_traduzir) {
+            if ((endereco_byte & PAGINA_MASCARA) > TAMANHO_PAGINA - 3) {
+                // traduz os três bytes antes de escrever: uma falta não deixa a palavra pela metade
+                const std::size_t fisicos[3] = {traduzir(endereco_byte, true), traduzir(endereco_byte + 1, true),
+                                                traduzir(endereco_byte + 2, true)};
+                const std::uint8_t bytes[3] = {static_cast<std::uint8_t>(valor >> 16), static_cast<std::uint8_t>(valor >> 8),
+                                               static_cast<std::uint8_t>(valor)};
+                escreverTraduzidos(fisicos, bytes, 3);
+                return;
+            }
+            endereco_byte = traduzir(endereco_byte, true);
+        }
+        escreverPalavraMemoria(endereco_byte, valor);
     };
 
+    // Eventos agendados (temporizadores, dispositivos lentos): uma comparação por passo
+    if (tempoSimulado() >= m_agenda.proximoPrazo()) {
+        m_agenda.disparar(tempoSimulado());
+    }
+    m_traduzir = m_num_paginas != 0 && cpu.r.modo == 0;
+
     std::size_t pc_inicial = cpu.r.PC;
     
-    // VERIFICAÇÃO DE LIMITE CRÍTICO
-    if (pc_inicial >= memoria.getTamanhoBytes()) {
+    // VERIFICAÇÃO DE LIMITE CRÍTICO (com paginação, quem limita o PC é a tabela de páginas)
+    if (!m_traduzir && pc_inicial >= memoria->getTamanhoBytes()) {
         std::cerr << "[FIM] PC fora dos limites da memória (PC = 0x" << std::hex << pc_inicial << std::dec << ")\n";
         m_running = false; // Desliga o flag se PC for inválido
+        m_falha = Falha::PC_FORA_DOS_LIMITES;
         return;
     }
+    ++m_instrucoes;
+    m_pc_instrucao = pc_inicial;
 
-    std::uint8_t byte1 = lerByte(pc_inicial);
+    // Páginas ainda idênticas à imagem carregada já têm as instruções decodificadas
+    InstrucaoDecodificada inst;
+    const InstrucaoDecodificada* cache = nullptr;
+    if (!m_compartilhada) {
+        if (!m_traduzir) {
+            cache = memoria->decodificadaCompartilhada(pc_inicial);
+        } else if ((pc_inicial & PAGINA_MASCARA) <= TAMANHO_PAGINA - 4) {
+            cache = memoria->decodificadaCompartilhada(traduzir(pc_inicial, false));
+        }
+    }
+    if (cache) {
+        inst = *cache;
+    } else if (m_traduzir) {
+        inst = buscarInstrucaoVirtual(pc_inicial);
+    } else {
+        inst = decodificar(lerByte(pc_inicial), lerByte(pc_inicial + 1), lerByte(pc_inicial + 2), lerByte(pc_inicial + 3));
+    }
 
-    std::uint8_t opcode = byte1 & 0xFC;
+    std::uint8_t opcode = inst.opcode;
+    if (m_perfil) {
+        m_perfil->registrar(pc_inicial, opcode);
+    }
+    if (m_rastro) { // os bytes já foram buscados (e traduzidos) acima
+        std::uint8_t bytes[4];
+        for (std::uint8_t k = 0; k < inst.tamanho; ++k) {
+            bytes[k] = lerByte(m_traduzir ? traduzir(pc_inicial + k, false) : pc_inicial + k);
+        }
+        m_rastro->registrar(static_cast<std::uint32_t>(pc_inicial), bytes, inst.tamanho, cpu.r);
+    }
+    CONTAR_LEITURA(m_traduzir ? traduzir(pc_inicial, false) : pc_inicial, inst.tamanho);
+
+    // Formato 1 byte: ponto flutuante
+    if (inst.formato == Formato::F1 && opcode != 0x4C) {
+        cpu.r.PC += 1;
+        switch (opcode) {
+            case 0xC0: { // FLOAT: F = A
+                cpu.r.F = static_cast<double>(cpu.r.A);
+                if (m_log) *m_log << "[EXEC] FLOAT - F = " << cpu.r.F << "\n";
+                break;
+            }
+            case 0xC4: { // FIX: A = F truncado
+                double inteiro = std::trunc(cpu.r.F);
+                if (!(inteiro >= -0x800000 && inteiro <= 0x7FFFFF)) {
+                    throw InterrupcaoPrograma(InterrupcaoPrograma::ERRO_ARITMETICO, "FIX fora da faixa de 24 bits.");
+                }
+                cpu.r.A = static_cast<std::int32_t>(inteiro);
+                if (m_log) *m_log << "[EXEC] FIX - A = " << cpu.r.A << "\n";
+                break;
+            }
+            case 0xC8: { // NORM: o F já é mantido normalizado
+                if (m_log) *m_log << "[EXEC] NORM\n";
+                break;
+            }
+        }
+        return;
+    }
 
     // Formato 1 byte
-    if (opcode == 0x4C) { // RSUB (Formato 1)
+    if (inst.formato == Formato::F1) { // RSUB (Formato 1)
         cpu.r.PC = cpu.r.L;
-        std::cout << "[EXEC] RSUB - PC = " << cpu.r.PC << "\n";
+        if (m_log) *m_log << "[EXEC] RSUB - PC = " << cpu.r.PC << "\n";
         m_running = false; // **CONDIÇÃO DE PARADA**
         return; 
     }
     
     // Formato 2 bytes
-    if (opcode == 0x90 || opcode == 0x04 || opcode == 0x98 || opcode == 0xAC ||
-        opcode == 0xA0 || opcode == 0x9C || opcode == 0xA4 || opcode == 0xA8 ||
-        opcode == 0x94 || opcode == 0xB8) {
+    if (inst.formato == Formato::F2) {
         cpu.r.PC += 2; 
-        std::uint8_t regs = lerByte(pc_inicial + 1);
-        std::uint8_t num_r1 = (regs >> 4) & 0x0F;
-        std::uint8_t num_r2 = regs & 0x0F;
+        std::uint8_t num_r1 = inst.r1;
+        std::uint8_t num_r2 = inst.r2;
+
+        if (opcode == 0xE4) { // HCALL n (extensão: n ocupa o segundo byte inteiro)
+            std::uint8_t numero = (num_r1 << 4) | num_r2;
+            chamadaHost(numero);
+            if (m_log) *m_log << "[EXEC] HCALL " << (int)numero << "\n";
+            return;
+        }
+
+        if (opcode == 0xB0) { // SVC n (r1 é o número do serviço, não um registrador)
+            if (m_log) *m_log << "[EXEC] SVC " << (int)num_r1 << "\n";
+            interromper(ClasseInterrupcao::SVC, num_r1);
+            return;
+        }
         
         try {
             std::int32_t& r1 = getRegistradorPorNumero(num_r1);
@@ -138,25 +948,25 @@ void Maquina::passo() {
             switch(opcode) {
                 case 0x04: { // CLEAR r1
                     r1 = 0;
-                    std::cout << "[EXEC] CLEAR - R" << (int)num_r1 << " = 0\n";
+                    if (m_log) *m_log << "[EXEC] CLEAR - R" << (int)num_r1 << " = 0\n";
                     break;
                 }
                 case 0x90: { // ADDR r1, r2
                     std::int32_t& r2 = getRegistradorPorNumero(num_r2);
                     r2 += r1;
-                    std::cout << "[EXEC] ADDR - R" << (int)num_r2 << " += R" << (int)num_r1 << "\n";
+                    if (m_log) *m_log << "[EXEC] ADDR - R" << (int)num_r2 << " += R" << (int)num_r1 << "\n";
                     break;
                 }
                 case 0x98: { // MULR r1, r2
                     std::int32_t& r2 = getRegistradorPorNumero(num_r2);
                     r2 *= r1;
-                    std::cout << "[EXEC] MULR - R" << (int)num_r2 << " *= R" << (int)num_r1 << "\n";
+                    if (m_log) *m_log << "[EXEC] MULR - R" << (int)num_r2 << " *= R" << (int)num_r1 << "\n";
                     break;
                 }
                 case 0xAC: { // RMO r1, r2
                     std::int32_t& r2 = getRegistradorPorNumero(num_r2);
                     r2 = r1;
-                    std::cout << "[EXEC] RMO - R" << (int)num_r2 << " = R" << (int)num_r1 << "\n";
+                    if (m_log) *m_log << "[EXEC] RMO - R" << (int)num_r2 << " = R" << (int)num_r1 << "\n";
                     break;
                 }
                 case 0xA0: { // COMPR r1, r2
@@ -169,34 +979,34 @@ void Maquina::passo() {
                     } else {
                         cpu.r.SW = BIGGER;
                     }
-                    std::cout << "[EXEC] COMPR - R" << (int)num_r1 << " : R" << (int)num_r2 << "\n";
+                    if (m_log) *m_log << "[EXEC] COMPR - R" << (int)num_r1 << " : R" << (int)num_r2 << "\n";
                     break;
                 }
                 case 0x9C: { // DIVR r1, r2
                     std::int32_t& r2 = getRegistradorPorNumero(num_r2);
                     if (r1 == 0) throw std::runtime_error("Divisao por zero em DIVR.");
                     r2 /= r1;
-                    std::cout << "[EXEC] DIVR - R" << (int)num_r2 << " /= R" << (int)num_r1 << "\n";
+                    if (m_log) *m_log << "[EXEC] DIVR - R" << (int)num_r2 << " /= R" << (int)num_r1 << "\n";
                     break;    
                 }
                 case 0xA4: { // SHIFTL r1, n
                     auto& n = num_r2;
                     int shift_amount = n + 1;
                     r1 <<= shift_amount;
-                    std::cout << "[EXEC] SHIFTL - R" << (int)num_r1 << " <<= N" << (int)shift_amount << "\n";
+                    if (m_log) *m_log << "[EXEC] SHIFTL - R" << (int)num_r1 << " <<= N" << (int)shift_amount << "\n";
                     break;
                 }
                 case 0xA8: { // SHIFTR r1, n
                     auto& n = num_r2;
                     int shift_amount = n + 1;
                     r1 >>= shift_amount;
-                    std::cout << "[EXEC] SHIFTR - R" << (int)num_r1 << " >>= N" << (int)shift_amount << "\n";
+                    if (m_log) *m_log << "[EXEC] SHIFTR - R" << (int)num_r1 << " >>= N" << (int)shift_amount << "\n";
                     break;
                 }
                 case 0x94: { // SUBR r1, r2
                     std::int32_t& r2 = getRegistradorPorNumero(num_r2);
                     r2 -= r1;
-                    std::cout << "[EXEC] SUBR - R" << (int)num_r2 << " -= R" << (int)num_r1 << "\n";
+                    if (m_log) *m_log << "[EXEC] SUBR - R" << (int)num_r2 << " -= R" << (int)num_r1 << "\n";
                     break;
                 }
                 case 0xB8: { // TIXR r1
@@ -209,11 +1019,16 @@ void Maquina::passo() {
                     } else {
                         cpu.r.SW = BIGGER;
                     }
-                    std::cout << "[EXEC] TIXR - X incrementado para " << cpu.r.X 
+                    if (m_log) *m_log << "[EXEC] TIXR - X incrementado para " << cpu.r.X 
                             << ". Comparando com R" << (int)num_r1 
                             << " -> SW = " << cpu.r.SW << "\n";
                     break;
                 }
+                case 0xBC: { // IDCPU r1 (extensão: número desta CPU em uma máquina com várias CPUs)
+                    r1 = cpu.id;
+                    if (m_log) *m_log << "[EXEC] IDCPU - R" << (int)num_r1 << " = " << (int)cpu.id << "\n";
+                    break;
+                }
             }
         } catch (const std::exception& e) {
             std::cerr << "ERRO de registrador em Formato 2: " << e.what() << std::endl;
@@ -223,43 +1038,28 @@ void Maquina::passo() {
     }
 
     // Formato 3/4
+    bool n = inst.n;
+    bool i = inst.i;
+    bool x = inst.x;
+    bool b = inst.b;
+    bool p = inst.p;
 
-    // Extrair ni do primeiro Byte
-    bool n = (byte1 >> 1) & 1;
-    bool i = byte1 & 1;
-
-    // Extrair xbpe do segundo Byte
-    std::uint8_t byte2 = lerByte(pc_inicial + 1);
-    bool x = (byte2 >> 7) & 1;
-    bool b = (byte2 >> 6) & 1;
-    bool p = (byte2 >> 5) & 1;
-    bool e = (byte2 >> 4) & 1;
-
-    std::int32_t disp;
+    std::int32_t disp = inst.disp;
     std::uint32_t target_address = 0;
 
-    if (e) { // Formato 4
-        if (pc_inicial + 3 >= memoria.getTamanhoBytes()) {
+    if (inst.formato == Formato::F4) { // Formato 4
+        if (!m_traduzir && pc_inicial + 3 >= memoria->getTamanhoBytes()) {
             std::cerr << "ERRO: Leitura do Formato 4 fora dos limites.\n";
             return;
         }
         cpu.r.PC += 4;
-        std::uint8_t byte3 = lerByte(pc_inicial + 2);
-        std::uint8_t byte4 = lerByte(pc_inicial + 3);
-        disp = ((byte2 & 0x0F) << 16) | (byte3 << 8) | byte4;
         target_address = disp;
     } else { // Formato 3
-        if (pc_inicial + 2 >= memoria.getTamanhoBytes()) {
+        if (!m_traduzir && pc_inicial + 2 >= memoria->getTamanhoBytes()) {
             std::cerr << "ERRO: Leitura do Formato 3 fora dos limites.\n";
             return;
         }
         cpu.r.PC += 3;
-        std::uint8_t byte3 = lerByte(pc_inicial + 2);
-        disp = ((byte2 & 0x0F) << 8) | byte3;
-        // Extensão de sinal para deslocamento de 12 bits (para PC e Base relative)
-        if (disp & 0x800) {
-            disp |= 0xFFFFF000;
-        }
 
         if (p) { // PC-relative
             target_address = cpu.r.PC + disp;
@@ -277,13 +1077,12 @@ void Maquina::passo() {
 
     // Obtenção do operando
     std::uint32_t operando;
+    std::uint32_t endereco_efetivo = target_address; // dos 6 bytes dos operandos de ponto flutuante
 
     // i==1 então Imediato
     if (i) {
         operando = target_address; 
     } else {
-        std::uint32_t endereco_efetivo = target_address;
-        
         // endereço de um ponteiro
         if (n) { 
             endereco_efetivo = lerPalavra(target_address);
@@ -292,31 +1091,40 @@ void Maquina::passo() {
         operando = lerPalavra(endereco_efetivo);
     }
 
+    // Operando de ponto flutuante: 48 bits na memória, ou o valor imediato convertido
+    auto lerFlutuante = [&]() -> double {
+        if (i) {
+            return static_cast<double>(target_address);
+        }
+        std::uint64_t bits = (std::uint64_t{operando} << 24) | lerPalavra(endereco_efetivo + 3);
+        return desempacotarFlutuante(bits);
+    };
+
     // Execução da instrução
     switch(opcode) {
         case 0x00: { // LDA m
             cpu.r.A = operando;
-            std::cout << "[EXEC] LDA - A = " << cpu.r.A << "\n";
+            if (m_log) *m_log << "[EXEC] LDA - A = " << cpu.r.A << "\n";
             break;
         }
         case 0x0C: { // STA m
             escreverPalavra(target_address, cpu.r.A);
-            std::cout << "[EXEC] STA - mem[" << target_address << "] = " << cpu.r.A << "\n";
+            if (m_log) *m_log << "[EXEC] STA - mem[" << target_address << "] = " << cpu.r.A << "\n";
             break;
         }
         case 0x18: { // ADD m
             cpu.r.A += operando;
-            std::cout << "[EXEC] ADD - A = " << cpu.r.A << "\n";
+            if (m_log) *m_log << "[EXEC] ADD - A = " << cpu.r.A << "\n";
             break;
         }
         case 0x3C: { // J m
             cpu.r.PC = target_address;
-            std::cout << "[EXEC] J - PC = " << cpu.r.PC << "\n";
+            if (m_log) *m_log << "[EXEC] J - PC = " << cpu.r.PC << "\n";
             break;
         }
         case 0x40: { // AND m
             cpu.r.A &= operando;
-            std::cout << "[EXEC] AND - A = " << cpu.r.A << " : m " << (int)operando << "\n";
+            if (m_log) *m_log << "[EXEC] AND - A = " << cpu.r.A << " : m " << (int)operando << "\n";
             break;
         }
         case 0x28: { // COMP m
@@ -328,7 +1136,7 @@ void Maquina::passo() {
                 cpu.r.SW = BIGGER;
             }
 
-            std::cout << "[EXEC] COMPR - A" << (int)cpu.r.A << " : m " << (int)operando << "\n";
+            if (m_log) *m_log << "[EXEC] COMPR - A" << (int)cpu.r.A << " : m " << (int)operando << "\n";
             break;
         }
         case 0x24: { // DIV m
@@ -337,126 +1145,141 @@ void Maquina::passo() {
                 return;
             }
             cpu.r.A /= operando;
-            std::cout << "[EXEC] DIV - A = " << cpu.r.A << "\n";
+            if (m_log) *m_log << "[EXEC] DIV - A = " << cpu.r.A << "\n";
             break;
         }
         case 0x30: { // JEQ m
             if (cpu.r.SW == EQUAL) {
                 cpu.r.PC = target_address;
             }
-            std::cout << "[EXEC] JEQ";
+            if (m_log) *m_log << "[EXEC] JEQ";
             break;
         }
         case 0x34: { // JGT m
             if (cpu.r.SW == BIGGER) {
                 cpu.r.PC = target_address;
             }
-            std::cout << "[EXEC] JGT";
+            if (m_log) *m_log << "[EXEC] JGT";
             break;
         }
         case 0x38: { // JLT m
             if (cpu.r.SW == SMALLER) {
                 cpu.r.PC = target_address;
             }
-            std::cout << "[EXEC] JLT";
+            if (m_log) *m_log << "[EXEC] JLT";
             break;
         }
         case 0x48: { // JSUB m
             cpu.r.L = cpu.r.PC;
             cpu.r.PC = target_address;
-            std::cout << "[EXEC] JSUB - L = " << cpu.r.L << ", PC = " << cpu.r.PC << "\n";
+            if (m_log) *m_log << "[EXEC] JSUB - L = " << cpu.r.L << ", PC = " << cpu.r.PC << "\n";
             break;
         }
         case 0x68: { // LDB m
             cpu.r.B = operando;
-            std::cout << "[EXEC] LDB - B = " << cpu.r.B << "\n";
+            if (m_log) *m_log << "[EXEC] LDB - B = " << cpu.r.B << "\n";
             break;
         }
         case 0x50: { // LDCH m
-            if (target_address >= memoria.getTamanhoBytes()) {
+            if (x && acelerarLacoDeBytes(inst, pc_inicial, target_address)) {
+                break;
+            }
+            std::size_t endereco = m_traduzir ? traduzir(target_address, false) : target_address;
+            if (endereco >= memoria->getTamanhoBytes()) {
                 std::cerr << "ERRO: LDCH fora dos limites.\n";
                 return;
             }
-            auto byte_carregado = lerByte(target_address);
+            CONTAR_LEITURA(endereco, 1);
+            auto byte_carregado = lerByte(endereco);
             auto a_preservado = cpu.r.A & 0xFFFF00;
             cpu.r.A = a_preservado | byte_carregado;
-            std::cout << "[EXEC] LDCH - A = " << cpu.r.A << "\n";
+            if (m_log) *m_log << "[EXEC] LDCH - A = " << cpu.r.A << "\n";
             break;
         }
         case 0x08: { // LDL m
             cpu.r.L = operando;
-            std::cout << "[EXEC] LDL - L = " << cpu.r.L << "\n";
+            if (m_log) *m_log << "[EXEC] LDL - L = " << cpu.r.L << "\n";
             break;
         }
         case 0x6C: { // LDS m
             cpu.r.S = operando;
-            std::cout << "[EXEC] LDS - S = " << cpu.r.S << "\n";
+            if (m_log) *m_log << "[EXEC] LDS - S = " << cpu.r.S << "\n";
             break;
         }
         case 0x74: { // LDT m
             cpu.r.T = operando;
-            std::cout << "[EXEC] LDT - T = " << cpu.r.T << "\n";
+            if (m_log) *m_log << "[EXEC] LDT - T = " << cpu.r.T << "\n";
             break;
         }
         case 0x04: { // LDX m
             cpu.r.X = operando;
-            std::cout << "[EXEC] LDX - X = " << cpu.r.X << "\n";
+            if (m_log) *m_log << "[EXEC] LDX - X = " << cpu.r.X << "\n";
             break;
         }
         case 0x20: { // MUL m
             cpu.r.A *= operando;
-            std::cout << "[EXEC] MUL - A = " << cpu.r.A << "\n";
+            if (m_log) *m_log << "[EXEC] MUL - A = " << cpu.r.A << "\n";
             break;
         }
         case 0x44: { // OR m
             cpu.r.A |= operando;
-            std::cout << "[EXEC] OR - A = " << cpu.r.A << "\n";
+            if (m_log) *m_log << "[EXEC] OR - A = " << cpu.r.A << "\n";
             break;
         }
         case 0x4C: { // RSUB m
             cpu.r.PC = cpu.r.L;
-            std::cout << "[EXEC] RSUB - PC = " << cpu.r.PC << "\n";
+            if (m_log) *m_log << "[EXEC] RSUB - PC = " << cpu.r.PC << "\n";
             m_running = false; // **CONDIÇÃO DE PARADA**
             break;
         }
         case 0x78: { // STB m 
             escreverPalavra(target_address, cpu.r.B);
-            std::cout << "[EXEC] STB - mem[" << target_address << "] = " << cpu.r.B << "\n";
+            if (m_log) *m_log << "[EXEC] STB - mem[" << target_address << "] = " << cpu.r.B << "\n";
             break;
         }
         case 0x54: { // STCH m
-            if (target_address >= memoria.getTamanhoBytes()) {
+            if (x && acelerarLacoDeBytes(inst, pc_inicial, target_address)) {
+                break;
+            }
+            std::size_t endereco = m_traduzir ? traduzir(target_address, true) : target_address;
+            if (endereco >= memoria->getTamanhoBytes()) {
                 std::cerr << "ERRO: STCH fora dos limites.\n";
                 return;
             }
             std::uint8_t byte_para_armazenar = cpu.r.A & 0xFF;
-            memoria.setByte(target_address, byte_para_armazenar);
-            std::cout << "[EXEC] STCH - mem[" << target_address << "] = " << (int)byte_para_armazenar << "\n";
+            ++m_escritas;
+            CONTAR_ESCRITA(endereco, 1);
+            if (m_compartilhada) {
+                memoria->setByteAtomico(endereco, byte_para_armazenar);
+            } else {
+                memoria->setByte(endereco, byte_para_armazenar);
+            }
+            if (m_log) *m_log << "[EXEC] STCH - mem[" << target_address << "] = " << (int)byte_para_armazenar << "\n";
             break;
         }
         case 0x14: { // STL m
             escreverPalavra(target_address, cpu.r.L);
-            std::cout << "[EXEC] STL - mem[" << target_address << "] = " << cpu.r.L << "\n";
+            if (m_log) *m_log << "[EXEC] STL - mem[" << target_address << "] = " << cpu.r.L << "\n";
             break;
         }
         case 0x7C: { // STS m
             escreverPalavra(target_address, cpu.r.S);
-            std::cout << "[EXEC] STS - mem[" << target_address << "] = " << cpu.r.S << "\n";
+            if (m_log) *m_log << "[EXEC] STS - mem[" << target_address << "] = " << cpu.r.S << "\n";
             break;
         }
         case 0x84: { // STT m
             escreverPalavra(target_address, cpu.r.T);
-            std::cout << "[EXEC] STT - mem[" << target_address << "] = " << cpu.r.T << "\n";
+            if (m_log) *m_log << "[EXEC] STT - mem[" << target_address << "] = " << cpu.r.T << "\n";
             break;  
         }
         case 0x10: { // STX m
             escreverPalavra(target_address, cpu.r.X);
-            std::cout << "[EXEC] STX - mem[" << target_address << "] = " << cpu.r.X << "\n";
+            if (m_log) *m_log << "[EXEC] STX - mem[" << target_address << "] = " << cpu.r.X << "\n";
             break;
         }
         case 0x1C: { // SUB m
             cpu.r.A -= operando;
-            std::cout << "[EXEC] SUB - A = " << cpu.r.A << "\n";
+            if (m_log) *m_log << "[EXEC] SUB - A = " << cpu.r.A << "\n";
             break;
         }
         case 0x2C: { // TIX m
@@ -468,14 +1291,130 @@ void Maquina::passo() {
             } else {
                 cpu.r.SW = BIGGER;
             }
-            std::cout << "[EXEC] TIX - X incrementado para " << cpu.r.X 
+            if (m_log) *m_log << "[EXEC] TIX - X incrementado para " << cpu.r.X 
                       << ". Comparando com m " << (int)operando
                       << " -> SW = " << cpu.r.SW << "\n";
             break;
         }
+        case 0xD8: { // RD m
+            exigirSupervisor("RD");
+            std::uint8_t numero = i ? (operando & 0xFF) : (operando >> 16) & 0xFF; // byte em m
+            std::uint8_t byte_lido;
+            if (!dispositivo(numero).ler(byte_lido)) {
+                aguardarDispositivo(pc_inicial, numero);
+                return;
+            }
+            cpu.r.A = (cpu.r.A & 0xFFFF00) | byte_lido;
+            if (m_log) *m_log << "[EXEC] RD - A = " << cpu.r.A << "\n";
+            break;
+        }
+        case 0xDC: { // WD m
+            exigirSupervisor("WD");
+            std::uint8_t numero = i ? (operando & 0xFF) : (operando >> 16) & 0xFF;
+            if (!dispositivo(numero).escrever(cpu.r.A & 0xFF)) {
+                aguardarDispositivo(pc_inicial, numero);
+                return;
+            }
+            ++m_escritas;
+            if (m_log) *m_log << "[EXEC] WD - dispositivo " << (int)numero << " <- " << (cpu.r.A & 0xFF) << "\n";
+            break;
+        }
+        case 0xE0: { // TD m (SMALLER = pronto, EQUAL = ocupado)
+            exigirSupervisor("TD");
+            std::uint8_t numero = i ? (operando & 0xFF) : (operando >> 16) & 0xFF;
+            if (dispositivo(numero).pronto()) {
+                cpu.r.SW = SMALLER;
+            } else if (detectarEsperaAtiva(pc_inicial)) {
+                // laço de espera: para no TD até o dispositivo ficar pronto
+                aguardarDispositivo(pc_inicial, numero);
+                return;
+            } else {
+                cpu.r.SW = EQUAL;
+            }
+            if (m_log) *m_log << "[EXEC] TD - dispositivo " << (int)numero << " -> SW = " << cpu.r.SW << "\n";
+            break;
+        }
+        case 0xD0: { // LPS m
+            exigirSupervisor("LPS");
+            carregarStatus(target_address);
+            if (m_log) *m_log << "[EXEC] LPS - PC = " << cpu.r.PC << ", modo " << (int)cpu.r.modo << "\n";
+            break;
+        }
+        case 0xD4: { // STI m (intervalo em instruções)
+            exigirSupervisor("STI");
+            iniciarTemporizador(operando & 0xFFFFFF);
+            if (m_log) *m_log << "[EXEC] STI - " << (operando & 0xFFFFFF) << "\n";
+            break;
+        }
+        case 0x70: { // LDF m
+            cpu.r.F = lerFlutuante();
+            if (m_log) *m_log << "[EXEC] LDF - F = " << cpu.r.F << "\n";
+            break;
+        }
+        case 0x80: { // STF m
+            std::uint64_t bits = empacotarFlutuante(cpu.r.F);
+            if (m_traduzir) {
+                // os seis bytes são traduzidos antes de escrever: uma falta na segunda
+                // palavra não deixa a primeira gravada
+                std::size_t fisicos[6];
+                std::uint8_t bytes[6];
+                for (std::size_t k = 0; k < 6; ++k) {
+                    fisicos[k] = traduzir(target_address + k, true);
+                    bytes[k] = (bits >> (40 - 8 * k)) & 0xFF;
+                }
+                escreverTraduzidos(fisicos, bytes, 6);
+            } else {
+                escreverPalavra(target_address, static_cast<std::uint32_t>(bits >> 24));
+                escreverPalavra(target_address + 3, static_cast<std::uint32_t>(bits & 0xFFFFFF));
+            }
+            if (m_log) *m_log << "[EXEC] STF - mem[" << target_address << "] = " << cpu.r.F << "\n";
+            break;
+        }
+        case 0x58: { // ADDF m
+            cpu.r.F += lerFlutuante();
+            if (m_log) *m_log << "[EXEC] ADDF - F = " << cpu.r.F << "\n";
+            break;
+        }
+        case 0x5C: { // SUBF m
+            cpu.r.F -= lerFlutuante();
+            if (m_log) *m_log << "[EXEC] SUBF - F = " << cpu.r.F << "\n";
+            break;
+        }
+        case 0x60: { // MULF m
+            cpu.r.F *= lerFlutuante();
+            if (m_log) *m_log << "[EXEC] MULF - F = " << cpu.r.F << "\n";
+            break;
+        }
+        case 0x64: { // DIVF m
+            double divisor = lerFlutuante();
+            if (divisor == 0.0) {
+                throw InterrupcaoPrograma(InterrupcaoPrograma::ERRO_ARITMETICO, "Divisao por zero em DIVF.");
+            }
+            cpu.r.F /= divisor;
+            if (m_log) *m_log << "[EXEC] DIVF - F = " << cpu.r.F << "\n";
+            break;
+        }
+        case 0x88: { // COMPF m
+            double valor = lerFlutuante();
+            if (cpu.r.F < valor) {
+                cpu.r.SW = SMALLER;
+            } else if (cpu.r.F == valor) {
+                cpu.r.SW = EQUAL;
+            } else {
+                cpu.r.SW = BIGGER;
+            }
+            if (m_log) *m_log << "[EXEC] COMPF - F " << cpu.r.F << " : m " << valor << "\n";
+            break;
+        }
+        case 0xCC: { // LPT m (extensão: endereço da tabela de páginas em m, número de páginas em m+3)
+            exigirSupervisor("LPT");
+            setTabelaPaginas(lerPalavraMemoria(target_address), lerPalavraMemoria(target_address + 3));
+            if (m_log) *m_log << "[EXEC] LPT - tabela em " << m_tabela_paginas << ", " << m_num_paginas << " paginas\n";
+            break;
+        }
         default:
              std::cerr << "[ERRO] Opcode F3/F4 não implementado: 0x" << std::hex << (int)opcode << std::dec << std::endl;
              // Lança exceção para tratamento de erro não implementado
-             throw std::runtime_error("Opcode F3/F4 nao implementado ou invalido.");
+             throw InterrupcaoPrograma(InterrupcaoPrograma::INSTRUCAO_ILEGAL, "Opcode F3/F4 nao implementado ou invalido.");
     }
 }
\ No newline at end of file
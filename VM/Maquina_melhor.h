@@ -3,33 +3,301 @@
 
 #include "CPU.h"
 #include "Memoria.h"
+#include "Decodificador.h"
+#include "ImagemCompartilhada.h"
+#include "Dispositivo.h"
+#include "AgendaEventos.h"
+#include "PerfilExecucao.h"
+#include "Rastro.h"
+#include "HistoricoExecucao.h"
+#ifdef VM_SIC_MAPA_ACESSOS
+#include "MapaAcessos.h"
+#endif
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
 #include <string>
 #include <stdexcept>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+// Motivo pelo qual a última execução terminou
+enum class Falha {
+    NENHUMA,              // parou normalmente (RSUB)
+    PC_FORA_DOS_LIMITES,  // PC saiu da memória
+    EXCECAO,              // opcode/registrador inválido, divisão por zero...
+    LIMITE_INSTRUCOES,    // orçamento de instruções esgotado
+    AGUARDANDO_DISPOSITIVO, // RD/WD em dispositivo não pronto; o PC aponta para a instrução
+    INTERROMPIDA          // parada pedida pelo host (solicitarParada); o PC aponta para a próxima
+};
+
+// Interrupção de programa (classe II). Se a classe estiver habilitada na máscara, o
+// núcleo convidado a recebe com o PC na instrução que falhou; senão a máquina para.
+class InterrupcaoPrograma : public std::runtime_error {
+public:
+    static constexpr std::uint8_t INSTRUCAO_ILEGAL = 0x00;
+    static constexpr std::uint8_t INSTRUCAO_PRIVILEGIADA = 0x01;
+    static constexpr std::uint8_t ENDERECO_INVALIDO = 0x02;
+    static constexpr std::uint8_t ERRO_ARITMETICO = 0x04;
+    static constexpr std::uint8_t FALTA_PAGINA = 0x10;
+    static constexpr std::uint8_t PROTECAO_PAGINA = 0x12;
+
+    std::uint8_t icode;
+    InterrupcaoPrograma(std::uint8_t codigo, const std::string& mensagem)
+        : std::runtime_error(mensagem), icode(codigo) {}
+};
+
+// Chamadas ao hospedeiro: HCALL n (opcode X'E4', formato 2, n no segundo byte; extensão
+// desta máquina). Rotinas nativas sobre a Memoria no lugar dos laços do convidado.
+// Registradores: S = destino/primeira cadeia, X = origem/segunda cadeia, T = tamanho, A = byte.
+enum ChamadaHost : std::uint8_t {
+    HCALL_CONSULTA = 0,  // A = máscara das chamadas disponíveis (bit n = chamada n)
+    HCALL_MOVER = 1,     // memmove(S, X, T bytes)
+    HCALL_PREENCHER = 2, // memset(S, A & 0xFF, T bytes)
+    HCALL_COMPARAR = 3,  // strcmp(S, X) até X'00': SW e A = diferença dos primeiros bytes distintos
+    HCALL_ORDENAR = 4    // ordena T palavras (24 bits com sinal) a partir de S
+};
+
+// Estado de referência para reinícios rápidos entre execuções (fuzzing, varreduras).
+// A memória guardada aqui é a fonte das páginas restauradas por reset_to(). Além da CPU
+// (com a máscara de interrupções) e da memória, guarda a tabela de páginas (LPT), o
+// temporizador e as interrupções pendentes. Eventos que o hospedeiro agendou com
+// agendarEvento não são guardados.
+struct EstadoBase {
+    Registradores regs;
+    Memoria memoria;
+    std::size_t tabela_paginas = 0;
+    std::size_t num_paginas = 0;
+    std::uint64_t temporizador = 0; // tempo que faltava para a interrupção (0 = parado)
+    std::uint8_t pendentes = 0;
+    std::array<std::uint8_t, 4> icode_pendente{};
+};
 
 class Maquina{
     private: 
     CPU cpu;
-    Memoria memoria;
+    Memoria m_memoria_propria;
+    Memoria* memoria;             // a própria, a compartilhada com outras CPUs ou uma visão (setMemoria)
+    bool m_compartilhada = false; // acessos atômicos (Memoria::tornarCompartilhada)
     bool m_running = false; // NOVO: Flag para controlar o ciclo de execução
+    std::atomic<bool> m_parada_solicitada{false}; // escrita por outra thread (GUI)
+    std::ostream* m_log = &std::cout; // Rastreamento das instruções (nullptr desliga)
+    PerfilExecucao* m_perfil = nullptr; // Contadores por opcode e por PC (nullptr desliga)
+    GravadorRastro* m_rastro = nullptr; // Rastro binário, um registro por instrução (nullptr desliga)
+    HistoricoExecucao* m_historico = nullptr; // O que cada passo mudou, para voltar (nullptr desliga)
+#ifdef VM_SIC_MAPA_ACESSOS
+    MapaAcessos m_mapa_acessos{memoria->getTamanhoBytes()}; // bytes lidos/escritos por linha
+#endif
+    std::uint64_t m_instrucoes = 0;   // Instruções executadas desde o carregamento
+    Falha m_falha = Falha::NENHUMA;
+    std::string m_erro;               // Mensagem da exceção quando m_falha == EXCECAO
+    AgendaEventos m_agenda;           // Eventos no tempo simulado (ver tempoSimulado())
+    std::uint64_t m_tempo_ocioso = 0; // Tempo saltado com a máquina ociosa, sem instruções executadas
+    // Relógio da agenda e do temporizador: as instruções executadas mais o tempo saltado
+    // enquanto o convidado esperava um dispositivo. O limite de executar(), o histórico e
+    // as medidas de desempenho contam só m_instrucoes.
+    std::uint64_t tempoSimulado() const { return m_instrucoes + m_tempo_ocioso; }
+
+    // Tabela de dispositivos (número do dispositivo -> backend)
+    std::array<std::shared_ptr<Dispositivo>, 256> m_dispositivos;
+    std::uint8_t m_dispositivo_aguardado = 0;
+    bool m_espera_no_host = true; // executar() dorme até o dispositivo ficar pronto
+    // esperarDispositivo() dorme aqui; acordada pelo aviso do dispositivo ou por solicitarParada()
+    std::mutex m_mtx_espera;
+    std::condition_variable m_cv_espera;
+
+    // Detecção de espera ativa (laço curto de TD em dispositivo ocupado, sem escritas)
+    static constexpr std::uint64_t LACO_ESPERA_MAX_INSTRUCOES = 8;
+    static constexpr unsigned LACO_ESPERA_REPETICOES = 4;
+    std::uint64_t m_escritas = 0; // escritas na memória e WDs, para saber se o laço tem efeito
+    std::size_t m_td_pc = 0;
+    std::uint64_t m_td_instrucao = 0;
+    std::uint64_t m_td_escritas = 0;
+    unsigned m_td_repeticoes = 0;
+
+    // Interrupções. Área de trabalho de cada classe (a partir de 0x100, 0x30 bytes cada):
+    // +0 nova SW, +3 novo PC, +6 SW salva, +9 PC salvo, +12 A, X, L, B, S, T (de 3 em 3),
+    // +30 F (6 bytes).
+    // LPS lê o mesmo formato da SW salva em diante, então "LPS área+6" retorna ao interrompido.
+    static constexpr std::uint32_t AREA_INTERRUPCOES = 0x100;
+    static constexpr std::uint32_t TAMANHO_AREA_INTERRUPCAO = 0x30;
+    std::size_t m_pc_instrucao = 0;      // PC da instrução em execução (interrupções de programa)
+    std::uint8_t m_pendentes = 0;        // MASCARA_* das interrupções assíncronas à espera
+    std::array<std::uint8_t, 4> m_icode_pendente{};
+    std::uint64_t m_evento_temporizador = 0; // id na agenda (0 = temporizador parado)
+    std::uint64_t m_prazo_temporizador = 0;
+
+    std::uint32_t lerPalavraMemoria(std::size_t endereco_byte);
+    void escreverPalavraMemoria(std::size_t endereco_byte, std::uint32_t valor);
+    void interromper(ClasseInterrupcao classe, std::uint8_t icode);
+    void entregarPendentes();
+    void carregarStatus(std::size_t endereco_byte);
+    void iniciarTemporizador(std::uint32_t intervalo);
+    void exigirSupervisor(const char* instrucao) const;
+
+    // Memória virtual (LPT). Só vale em modo usuário; o supervisor usa endereços físicos.
+    // Entrada da tabela (uma palavra por página de TAMANHO_PAGINA bytes):
+    // bit 23 válida, 22 gravável, 21 referenciada, 20 modificada, 0-15 quadro físico.
+    // A CPU liga os bits 21/20 ao carregar a TLB; depois de alterar a tabela, execute LPT de novo.
+    static constexpr std::uint32_t PAGINA_VALIDA = 0x800000;
+    static constexpr std::uint32_t PAGINA_GRAVAVEL = 0x400000;
+    static constexpr std::uint32_t PAGINA_REFERENCIADA = 0x200000;
+    static constexpr std::uint32_t PAGINA_MODIFICADA = 0x100000;
+    static constexpr std::uint32_t PAGINA_QUADRO = 0x00FFFF;
+    static constexpr std::size_t ENDERECO_FALTA = 0x24; // na área da classe PROGRAMA: endereço virtual da falta
+    static constexpr std::size_t TLB_ENTRADAS = 64;
+
+    struct EntradaTLB {
+        std::size_t pagina = std::numeric_limits<std::size_t>::max(); // página virtual (vazia = max)
+        std::ptrdiff_t deslocamento = 0;                             // físico - virtual
+    };
+    std::array<EntradaTLB, TLB_ENTRADAS> m_tlb_leitura;
+    std::array<EntradaTLB, TLB_ENTRADAS> m_tlb_escrita; // só páginas graváveis
+    std::size_t m_tabela_paginas = 0;
+    std::size_t m_num_paginas = 0; // 0 = paginação desligada
+    bool m_traduzir = false;       // paginação ligada e CPU em modo usuário (recalculado a cada passo)
+
+    // Endereço virtual -> físico. Acerto na TLB: uma comparação e uma soma.
+    std::size_t traduzir(std::size_t endereco_virtual, bool escrita) {
+        std::size_t pagina = endereco_virtual >> PAGINA_BITS;
+        const EntradaTLB& e = (escrita ? m_tlb_escrita : m_tlb_leitura)[pagina % TLB_ENTRADAS];
+        if (e.pagina == pagina) {
+            return endereco_virtual + e.deslocamento;
+        }
+        return preencherTLB(endereco_virtual, escrita);
+    }
+    std::size_t preencherTLB(std::size_t endereco_virtual, bool escrita);
+    void limparTLB();
+    InstrucaoDecodificada buscarInstrucaoVirtual(std::size_t pc_virtual);
+
+    // Laços de bytes reconhecidos em passo() e executados em bloco (cópia: LDCH/STCH/TIXR/JLT,
+    // preenchimento: STCH/TIXR/JLT, ambos indexados por X). Só dentro de executar(), sem
+    // rastreamento, paginação ou memória compartilhada; PCs recusados ficam numa cache.
+    static constexpr std::size_t IDIOMAS_RECUSADOS = 64;
+    std::array<std::size_t, IDIOMAS_RECUSADOS> m_idiomas_recusados;
+    std::uint64_t m_fim_orcamento = 0; // contador em que executar() para (0 = fora de executar)
+    bool acelerarLacoDeBytes(const InstrucaoDecodificada& primeira, std::size_t pc, std::uint32_t alvo);
+    InstrucaoDecodificada decodificarEm(std::size_t endereco) const;
+    void executarPasso();
+
+    void chamadaHost(std::uint8_t numero);
+    bool acessoDiretoHost(std::size_t inicio, std::size_t quantidade) const;
+    void verificarFaixaHost(std::size_t inicio, std::size_t quantidade, bool escrita);
+    std::uint8_t lerByteHost(std::size_t endereco);
+    void escreverByteHost(std::size_t endereco, std::uint8_t valor);
+
+    Dispositivo& dispositivo(std::uint8_t numero);
+    void aguardarDispositivo(std::size_t pc_instrucao, std::uint8_t numero);
+    bool detectarEsperaAtiva(std::size_t pc_instrucao);
+    void esperarDispositivo(std::uint8_t numero);
 
     public: 
     explicit Maquina(std::size_t tamanho_memoria = 1024);
+    // CPU 'id_cpu' de uma máquina com várias CPUs; 'compartilhada' já deve estar no modo compartilhado
+    Maquina(Memoria& compartilhada, std::uint8_t id_cpu);
+    Maquina(const Maquina&) = delete;
+    Maquina& operator=(const Maquina&) = delete;
     void carregarPrograma(const std::string& caminhoArquivo);
-    void executar();
+    void carregarImagem(const std::vector<std::uint8_t>& imagem);
+    void carregarImagem(std::shared_ptr<const ImagemCompartilhada> imagem);
+    // Zera o que sobrou da execução anterior (contadores, tempo ocioso, agenda, interrupções
+    // pendentes, tabela de páginas, histórico) para um programa novo; memória e registradores
+    // ficam por conta de quem chama. Os carregarImagem/carregarPrograma já chamam.
+    void reiniciarEstado();
+    Falha executar(std::uint64_t limite_instrucoes = std::numeric_limits<std::uint64_t>::max());
     void passo();
     std::int32_t& getRegistradorPorNumero(std::uint8_t num);
 
+    // Captura o estado atual como baseline e começa a rastrear páginas sujas a partir dele
+    EstadoBase criarBaseline();
+    // Volta ao baseline copiando só as páginas escritas desde então (e os registradores,
+    // a tabela de páginas, o temporizador e as interrupções pendentes)
+    void reset_to(const EstadoBase& baseline);
+
     // ACCESSORS PARA A GUI
     CPU& getCPU() { return cpu; }
     const CPU& getCPU() const { return cpu; }
-    Memoria& getMemoria() { return memoria; }
-    const Memoria& getMemoria() const { return memoria; }
+    Memoria& getMemoria() { return *memoria; }
+    const Memoria& getMemoria() const { return *memoria; }
+    // Passa a executar sobre 'outra' (ex.: a visão privada de uma CPU no modo determinístico
+    // da MaquinaMulticore), que deve ter o tamanho da atual e viver enquanto estiver em uso.
+    // Registradores, dispositivos, agenda e contadores continuam os mesmos.
+    void setMemoria(Memoria& outra) {
+        memoria = &outra;
+        m_compartilhada = outra.isCompartilhada();
+        limparTLB();
+    }
     
     // NOVO: Verifica se a VM está rodando
     bool is_running() const { return m_running; }
+
+    // Pede que executar() pare antes da próxima instrução, retornando Falha::INTERROMPIDA.
+    // Pode ser chamada de qualquer thread; se nada estiver executando, vale para a próxima
+    // chamada de executar(), a menos que seja descartada antes.
+    void solicitarParada() {
+        {
+            std::lock_guard<std::mutex> trava(m_mtx_espera); // não se perde entre o teste e o wait
+            m_parada_solicitada.store(true, std::memory_order_relaxed);
+        }
+        m_cv_espera.notify_all();
+    }
+    void descartarPedidoParada() { m_parada_solicitada.store(false, std::memory_order_relaxed); }
+
+    void conectarDispositivo(std::uint8_t numero, std::shared_ptr<Dispositivo> dispositivo) {
+        m_dispositivos[numero] = std::move(dispositivo);
+    }
+    const std::shared_ptr<Dispositivo>& getDispositivo(std::uint8_t numero) const { return m_dispositivos[numero]; }
+    // Dispositivo que deixou a máquina em Falha::AGUARDANDO_DISPOSITIVO
+    std::uint8_t getDispositivoAguardado() const { return m_dispositivo_aguardado; }
+    // executar() já descarrega quando para por outro motivo que não o limite de instruções
+    void descarregarDispositivos();
+    // Com false, executar() retorna AGUARDANDO_DISPOSITIVO em vez de dormir (escalonadores).
+    // Nos dois modos, com eventos na agenda a máquina ociosa salta até o próximo deles.
+    void setEsperaNoHost(bool esperar) { m_espera_no_host = esperar; }
+
+    // Pede uma interrupção assíncrona (TEMPORIZADOR ou ES), entregue antes da próxima
+    // instrução em que a classe estiver habilitada. Chame da thread da máquina (por
+    // exemplo, numa ação de agendarEvento).
+    void solicitarInterrupcao(ClasseInterrupcao classe, std::uint8_t icode = 0);
+    // Tabela de páginas dos programas em modo usuário (o mesmo que LPT); 0 páginas desliga
+    void setTabelaPaginas(std::size_t endereco_tabela, std::size_t num_paginas);
+    // Tempo simulado que falta para a interrupção do temporizador (0 = parado)
+    std::uint64_t getTemporizador() const;
+
+    // Executa 'acao' quando o tempo simulado avançar 'atraso' (0 = antes da próxima instrução).
+    // A agenda é esvaziada ao carregar um programa e em reset_to().
+    std::uint64_t agendarEvento(std::uint64_t atraso, AgendaEventos::Acao acao) {
+        return m_agenda.agendar(tempoSimulado() + atraso, std::move(acao));
+    }
+    bool cancelarEvento(std::uint64_t id) { return m_agenda.cancelar(id); }
+
+    void setLog(std::ostream* saida) { m_log = saida; }
+    std::ostream* getLog() const { return m_log; }
+    // O perfil conta cada passo(); as iterações de um laço de bytes executado em bloco
+    // (ver acelerarLacoDeBytes) entram como um passo só. Não é do dono da máquina.
+    void setPerfil(PerfilExecucao* perfil) { m_perfil = perfil; }
+    // Grava o estado antes de cada passo(); com o rastro ligado os laços de bytes não são
+    // acelerados, para que cada instrução executada tenha o seu registro. Não é do dono da máquina.
+    void setRastro(GravadorRastro* rastro) { m_rastro = rastro; }
+    // Cada passo(), com a interrupção de programa que ele entregar, vira uma entrada
+    // do histórico. Ignorado com memória compartilhada. Não é do dono da máquina.
+    void setHistorico(HistoricoExecucao* historico) { m_historico = historico; }
+    // Desfaz até 'n' passos do histórico e deixa a máquina parada; retorna quantos voltaram
+    std::size_t voltarPassos(std::size_t n);
+#ifdef VM_SIC_MAPA_ACESSOS
+    // Acessos da CPU à memória física (busca, operandos, interrupções, HCALL); a carga do
+    // programa e as leituras da GUI não contam
+    MapaAcessos& getMapaAcessos() { return m_mapa_acessos; }
+    const MapaAcessos& getMapaAcessos() const { return m_mapa_acessos; }
+#endif
+    std::uint64_t getContadorInstrucoes() const { return m_instrucoes; }
+    Falha getFalha() const { return m_falha; }
+    const std::string& getErro() const { return m_erro; }
 };
 
 #endif
\ No newline at end of file
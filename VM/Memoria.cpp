@@ -3,15 +3,28 @@
 //
 
 #include "Memoria.h"
+#include "ImagemCompartilhada.h"
+#include <algorithm>
+
+// página de zeros compartilhada por todas as memórias: construir uma Memoria não zera nada
+static const Pagina PAGINA_ZERO{};
+
+Memoria::Memoria(std::size_t tamanho_em_palavras) : m_tamanho(tamanho_em_palavras * 3) {
+    std::size_t paginas = (m_tamanho + TAMANHO_PAGINA - 1) >> PAGINA_BITS;
+    m_leitura.assign(paginas, PAGINA_ZERO.data());
+    m_donos.resize(paginas);
+    m_exclusivas.marcas.resize(paginas, 0);
+    m_pagina_suja.resize(paginas, 0);
+}
 
 // lê 3 bytes da memória e combina eles em um inteiro de 32 bits
 std::uint32_t Memoria::read(std::size_t endereço_palavra) const {
     std::size_t endereço_byte = endereço_palavra * 3;
 
     // pega os 3 bytes individuais
-    std::uint8_t byte1 = m_bytes[endereço_byte]; // byte mais significativo
-    std::uint8_t byte2 = m_bytes[endereço_byte + 1];
-    std::uint8_t byte3 = m_bytes[endereço_byte + 2]; // byte menos significativo
+    std::uint8_t byte1 = getByte(endereço_byte); // byte mais significativo
+    std::uint8_t byte2 = getByte(endereço_byte + 1);
+    std::uint8_t byte3 = getByte(endereço_byte + 2); // byte menos significativo
 
     // combina os 3 bytes em um único inteiro usando SHIFT e OR
     std::int32_t valor_palavra = (byte1 << 16) | (byte2 << 8) | byte3;
@@ -23,7 +36,199 @@ void Memoria::write(std::size_t endereço_palavra, std::int32_t valor) {
     size_t endereço_byte = endereço_palavra * 3;
 
     // cada linha desloca os 8 bits corretos, e faz uma AND com 0xFF para apagar o resto
-    m_bytes[endereço_byte]     = (valor >> 16) & 0xFF;
-    m_bytes[endereço_byte + 1] = (valor >> 8)  & 0xFF;
-    m_bytes[endereço_byte + 2] = valor         & 0xFF;
-}
\ No newline at end of file
+    setByte(endereço_byte,     (valor >> 16) & 0xFF);
+    setByte(endereço_byte + 1, (valor >> 8)  & 0xFF);
+    setByte(endereço_byte + 2, valor         & 0xFF);
+}
+
+void Memoria::copiarBytes(std::size_t inicio, std::size_t quantidade, std::uint8_t* destino) const {
+    std::size_t fim = std::min(inicio + quantidade, m_tamanho);
+    std::size_t endereco = inicio;
+
+    // copia página a página
+    while (endereco < fim) {
+        std::size_t deslocamento = endereco & PAGINA_MASCARA;
+        std::size_t n = std::min(TAMANHO_PAGINA - deslocamento, fim - endereco);
+        std::copy_n(m_leitura[endereco >> PAGINA_BITS] + deslocamento, n, destino);
+        destino += n;
+        endereco += n;
+    }
+    if (endereco < inicio + quantidade) {
+        std::fill_n(destino, inicio + quantidade - std::max(endereco, inicio), 0);
+    }
+}
+
+std::vector<std::uint8_t> Memoria::getBytes(std::size_t inicio, std::size_t quantidade) const {
+    std::vector<std::uint8_t> bytes(quantidade);
+    copiarBytes(inicio, quantidade, bytes.data());
+    return bytes;
+}
+
+void Memoria::escreverBytes(std::size_t inicio, const std::uint8_t* origem, std::size_t quantidade) {
+    std::size_t fim = std::min(inicio + quantidade, m_tamanho);
+    if (m_diario_desfazer) {
+        anotarDesfazer(inicio, fim);
+    }
+    for (std::size_t endereco = inicio; endereco < fim;) {
+        std::size_t pagina = endereco >> PAGINA_BITS;
+        std::size_t deslocamento = endereco & PAGINA_MASCARA;
+        std::size_t n = std::min(TAMANHO_PAGINA - deslocamento, fim - endereco);
+        std::copy_n(origem, n, paginaGravavel(pagina) + deslocamento);
+        marcarSuja(pagina);
+        origem += n;
+        endereco += n;
+    }
+    if (m_registrar) {
+        registrarFaixa(inicio, fim);
+    }
+}
+
+void Memoria::preencherBytes(std::size_t inicio, std::uint8_t valor, std::size_t quantidade) {
+    std::size_t fim = std::min(inicio + quantidade, m_tamanho);
+    if (m_diario_desfazer) {
+        anotarDesfazer(inicio, fim);
+    }
+    for (std::size_t endereco = inicio; endereco < fim;) {
+        std::size_t pagina = endereco >> PAGINA_BITS;
+        std::size_t deslocamento = endereco & PAGINA_MASCARA;
+        std::size_t n = std::min(TAMANHO_PAGINA - deslocamento, fim - endereco);
+        std::fill_n(paginaGravavel(pagina) + deslocamento, n, valor);
+        marcarSuja(pagina);
+        endereco += n;
+    }
+    if (m_registrar) {
+        registrarFaixa(inicio, fim);
+    }
+}
+
+void Memoria::registrarFaixa(std::size_t inicio, std::size_t fim) {
+    if (inicio >= fim) {
+        return;
+    }
+    if (fim - inicio > m_limite_registro - std::min(m_limite_registro, m_registro_escritas.size())) {
+        m_registro_transbordou = true; // nem tudo cabe: não registra só uma parte
+        return;
+    }
+    for (std::size_t endereco = inicio; endereco < fim; ++endereco) {
+        m_registro_escritas.push_back(static_cast<std::uint32_t>(endereco));
+    }
+}
+
+void Memoria::anotarDesfazer(std::size_t inicio, std::size_t fim) {
+    for (std::size_t endereco = inicio; endereco < fim; ++endereco) {
+        m_diario_desfazer->push_back(static_cast<std::uint32_t>(endereco << 8) | getByte(endereco));
+    }
+}
+
+void Memoria::copiarPaginasDe(const Memoria& origem) {
+    const std::size_t paginas = std::min(m_leitura.size(), origem.m_leitura.size());
+    for (std::size_t p = 0; p < paginas; ++p) {
+        if (m_leitura[p] == origem.m_leitura[p]) {
+            continue; // mesma página compartilhada: mesmo conteúdo
+        }
+        m_donos[p] = origem.m_donos[p];
+        m_leitura[p] = origem.m_leitura[p];
+        m_exclusivas.marcas[p] = 0;
+        marcarSuja(p);
+        if (m_registrar) {
+            registrarFaixa(p << PAGINA_BITS, std::min((p + 1) << PAGINA_BITS, m_tamanho));
+        }
+    }
+    m_imagem = origem.m_imagem; // páginas da imagem continuam reconhecidas pela decodificação
+}
+
+void Memoria::carregarImagem(std::shared_ptr<const ImagemCompartilhada> imagem) {
+    const std::vector<std::shared_ptr<Pagina>>& paginas = imagem->getPaginas();
+    std::size_t n = std::min(paginas.size(), m_leitura.size());
+
+    for (std::size_t p = 0; p < n; ++p) {
+        m_donos[p] = paginas[p];
+        m_leitura[p] = paginas[p]->data();
+        m_exclusivas.marcas[p] = 0;
+        marcarSuja(p);
+    }
+    m_imagem = std::move(imagem);
+}
+
+const InstrucaoDecodificada* Memoria::decodificadaCompartilhada(std::size_t endereco) const {
+    if (!m_imagem || endereco + 3 >= m_imagem->getTamanho() || endereco + 3 >= m_tamanho) {
+        return nullptr;
+    }
+
+    // a instrução (até 4 bytes) pode atravessar duas páginas; ambas precisam ser as da imagem
+    const std::vector<std::shared_ptr<Pagina>>& paginas = m_imagem->getPaginas();
+    std::size_t p1 = endereco >> PAGINA_BITS;
+    std::size_t p2 = (endereco + 3) >> PAGINA_BITS;
+    if (m_leitura[p1] != paginas[p1]->data() || m_leitura[p2] != paginas[p2]->data()) {
+        return nullptr;
+    }
+    return &m_imagem->getDecodificada(endereco);
+}
+
+void Memoria::tornarCompartilhada() {
+    for (std::size_t p = 0; p < m_donos.size(); ++p) {
+        paginaGravavel(p);
+    }
+    m_imagem.reset();
+    m_travas = std::make_shared<TravasPalavra>();
+}
+
+std::uint8_t Memoria::getByteAtomico(std::size_t endereco_byte) const {
+    if (endereco_byte >= m_tamanho) {
+        return 0;
+    }
+    std::uint8_t& byte = (*m_donos[endereco_byte >> PAGINA_BITS])[endereco_byte & PAGINA_MASCARA];
+    return std::atomic_ref<std::uint8_t>(byte).load(std::memory_order_relaxed);
+}
+
+void Memoria::setByteAtomico(std::size_t endereco_byte, std::uint8_t valor) {
+    if (endereco_byte < m_tamanho) {
+        std::uint8_t& byte = (*m_donos[endereco_byte >> PAGINA_BITS])[endereco_byte & PAGINA_MASCARA];
+        std::atomic_ref<std::uint8_t>(byte).store(valor, std::memory_order_relaxed);
+    }
+}
+
+// trava de espera ativa: as seções críticas são de três bytes
+static void travar(std::atomic_flag& trava) {
+    while (trava.test_and_set(std::memory_order_acquire)) {
+        while (trava.test(std::memory_order_relaxed)) {}
+    }
+}
+
+std::uint32_t Memoria::lerPalavraAtomica(std::size_t endereco_byte) const {
+    std::atomic_flag& trava = (*m_travas)[endereco_byte % NUM_TRAVAS_PALAVRA];
+    travar(trava);
+    std::uint32_t valor = (getByteAtomico(endereco_byte) << 16) |
+                          (getByteAtomico(endereco_byte + 1) << 8) |
+                           getByteAtomico(endereco_byte + 2);
+    trava.clear(std::memory_order_release);
+    return valor;
+}
+
+void Memoria::escreverPalavraAtomica(std::size_t endereco_byte, std::uint32_t valor) {
+    std::atomic_flag& trava = (*m_travas)[endereco_byte % NUM_TRAVAS_PALAVRA];
+    travar(trava);
+    setByteAtomico(endereco_byte, (valor >> 16) & 0xFF);
+    setByteAtomico(endereco_byte + 1, (valor >> 8) & 0xFF);
+    setByteAtomico(endereco_byte + 2, valor & 0xFF);
+    trava.clear(std::memory_order_release);
+}
+
+void Memoria::limparPaginasSujas() {
+    for (std::uint32_t pagina : m_paginas_sujas) {
+        m_pagina_suja[pagina] = 0;
+    }
+    m_paginas_sujas.clear();
+}
+
+// restaura só as páginas escritas desde a captura de 'base', voltando a compartilhá-las
+void Memoria::restaurarPaginasSujas(const Memoria& base) {
+    for (std::uint32_t pagina : m_paginas_sujas) {
+        m_donos[pagina] = base.m_donos[pagina];
+        m_leitura[pagina] = base.m_leitura[pagina];
+        m_exclusivas.marcas[pagina] = 0;
+        m_pagina_suja[pagina] = 0;
+    }
+    m_paginas_sujas.clear();
+    m_imagem = base.m_imagem;
+}
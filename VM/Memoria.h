@@ -6,37 +6,206 @@
 #define VM_SIC_MEMORY_H
 
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 constexpr std::size_t MEMORIA_TAMANHO = 131072; // 32KB
 
+// Granularidade das páginas: rastreamento de páginas sujas e cópia na escrita (256 bytes)
+constexpr std::size_t PAGINA_BITS = 8;
+constexpr std::size_t TAMANHO_PAGINA = std::size_t{1} << PAGINA_BITS;
+constexpr std::size_t PAGINA_MASCARA = TAMANHO_PAGINA - 1;
+
+using Pagina = std::array<std::uint8_t, TAMANHO_PAGINA>;
+
+// Travas das palavras no modo compartilhado (várias CPUs), escolhidas pelo endereço
+constexpr std::size_t NUM_TRAVAS_PALAVRA = 256;
+using TravasPalavra = std::array<std::atomic_flag, NUM_TRAVAS_PALAVRA>;
+
+class ImagemCompartilhada;
+struct InstrucaoDecodificada;
+
+// A memória é uma tabela de páginas. Páginas nunca escritas apontam para uma página de
+// zeros global ou para as páginas de uma ImagemCompartilhada; a primeira escrita em uma
+// página compartilhada (por outra Memoria, pela imagem ou por uma cópia) a duplica.
 class Memoria {
 private:
-    std::vector<std::uint8_t> m_bytes;
+    std::size_t m_tamanho;
+    std::vector<const std::uint8_t*> m_leitura;    // dados visíveis de cada página
+    std::vector<std::shared_ptr<Pagina>> m_donos; // posse da página (nullptr = página de zeros)
+    std::shared_ptr<const ImagemCompartilhada> m_imagem; // última imagem carregada (cache de decodificação)
+    std::shared_ptr<TravasPalavra> m_travas;             // não nulo no modo compartilhado
 
-public:
-    Memoria(std::size_t tamanho_em_palavras = MEMORIA_TAMANHO) {
-        m_bytes.resize(tamanho_em_palavras * 3, 0);
+    // Uma marca por página + lista das páginas marcadas, para que o reset
+    // percorra só o que foi escrito e não a memória inteira.
+    std::vector<std::uint8_t> m_pagina_suja;
+    std::vector<std::uint32_t> m_paginas_sujas;
+
+    // Endereços escritos, em ordem (só quando o registro está ativo). Passando do limite,
+    // o registro para de crescer e só anota que transbordou.
+    bool m_registrar = false;
+    bool m_registro_transbordou = false;
+    std::size_t m_limite_registro = SIZE_MAX;
+    std::vector<std::uint32_t> m_registro_escritas;
+
+    void registrarEscrita(std::size_t endereco_byte) {
+        if (m_registro_escritas.size() < m_limite_registro) {
+            m_registro_escritas.push_back(static_cast<std::uint32_t>(endereco_byte));
+        } else {
+            m_registro_transbordou = true;
+        }
+    }
+    void registrarFaixa(std::size_t inicio, std::size_t fim);
+
+    // Bytes sobrescritos, anotados antes de cada escrita para que ela possa ser desfeita
+    // (HistoricoExecucao). nullptr desliga.
+    std::vector<std::uint32_t>* m_diario_desfazer = nullptr;
+    void anotarDesfazer(std::size_t inicio, std::size_t fim);
+
+    void marcarSuja(std::size_t pagina) {
+        if (!m_pagina_suja[pagina]) {
+            m_pagina_suja[pagina] = 1;
+            m_paginas_sujas.push_back(static_cast<std::uint32_t>(pagina));
+        }
+    }
+
+    // Uma marca por página criada por esta Memoria e nunca entregue a outra: só essas são
+    // escritas no lugar. Não se usa use_count(): com as páginas espalhadas por várias
+    // threads (BatchRunner, pontos do histórico), ver 1 não garante que a última leitura
+    // de quem soltou a página já terminou. Uma cópia nasce sem marcas; a origem não é
+    // tocada (pode estar sendo copiada por outras threads), então quem vai continuar
+    // escrevendo nela chama compartilharPaginas() antes de copiá-la.
+    struct PaginasExclusivas {
+        std::vector<std::uint8_t> marcas;
+
+        PaginasExclusivas() = default;
+        PaginasExclusivas(const PaginasExclusivas& outra) : marcas(outra.marcas.size(), 0) {}
+        PaginasExclusivas& operator=(const PaginasExclusivas& outra) {
+            marcas.assign(outra.marcas.size(), 0);
+            return *this;
+        }
+        PaginasExclusivas(PaginasExclusivas&&) = default;
+        PaginasExclusivas& operator=(PaginasExclusivas&&) = default;
     };
+    PaginasExclusivas m_exclusivas;
+
+    // Garante que a página seja exclusiva desta Memoria antes de escrever nela
+    std::uint8_t* paginaGravavel(std::size_t pagina) {
+        std::shared_ptr<Pagina>& dono = m_donos[pagina];
+        if (!m_exclusivas.marcas[pagina]) {
+            dono = std::make_shared<Pagina>(*reinterpret_cast<const Pagina*>(m_leitura[pagina]));
+            m_leitura[pagina] = dono->data();
+            m_exclusivas.marcas[pagina] = 1;
+        }
+        return dono->data();
+    }
+
+public:
+    Memoria(std::size_t tamanho_em_palavras = MEMORIA_TAMANHO);
     std::uint32_t read(std::size_t endereço_palavra) const;
     void write(std::size_t endereço_palavra, std::int32_t valor);
 
+    std::uint8_t getByte(std::size_t endereco_byte) const {
+        if (endereco_byte < m_tamanho) {
+            return m_leitura[endereco_byte >> PAGINA_BITS][endereco_byte & PAGINA_MASCARA];
+        }
+        return 0; // Retorna 0 se fora dos limites
+    }
+
     void setByte(std::size_t endereco_byte, std::uint8_t valor) {
        // Correção do erro lógico: só escreve se o endereço estiver dentro dos limites.
-       if(endereco_byte < m_bytes.size()) { 
-        m_bytes[endereco_byte] = valor;
+       if(endereco_byte < m_tamanho) { 
+        std::size_t pagina = endereco_byte >> PAGINA_BITS;
+        if (m_diario_desfazer) {
+            m_diario_desfazer->push_back(static_cast<std::uint32_t>(endereco_byte << 8) | getByte(endereco_byte));
+        }
+        paginaGravavel(pagina)[endereco_byte & PAGINA_MASCARA] = valor;
+        marcarSuja(pagina);
+        if (m_registrar) {
+            registrarEscrita(endereco_byte);
+        }
     } } 
 
     std:: size_t getTamanhoBytes() const{
-        return m_bytes.size();
+        return m_tamanho;
+    }
+
+    // Copia 'quantidade' bytes a partir de 'inicio' (bytes fora dos limites viram 0)
+    void copiarBytes(std::size_t inicio, std::size_t quantidade, std::uint8_t* destino) const;
+    std::vector<std::uint8_t> getBytes(std::size_t inicio, std::size_t quantidade) const;
+
+    // Escritas em bloco (página a página, com cópia na escrita, páginas sujas e registro
+    // como em setByte). Bytes fora dos limites são ignorados.
+    void escreverBytes(std::size_t inicio, const std::uint8_t* origem, std::size_t quantidade);
+    void preencherBytes(std::size_t inicio, std::uint8_t valor, std::size_t quantidade);
+
+    // Mapeia as páginas da imagem a partir do endereço 0 sem copiá-las
+    void carregarImagem(std::shared_ptr<const ImagemCompartilhada> imagem);
+
+    // Instrução já decodificada pela imagem, se os bytes em 'endereco' ainda são os dela
+    const InstrucaoDecodificada* decodificadaCompartilhada(std::size_t endereco) const;
+
+    // Prepara a memória para várias CPUs ao mesmo tempo: todas as páginas viram privadas,
+    // de modo que a tabela de páginas não muda mais durante a execução.
+    void tornarCompartilhada();
+    bool isCompartilhada() const { return m_travas != nullptr; }
+
+    // Acessos do modo compartilhado. Bytes são atômicos; uma palavra é lida/escrita
+    // inteira sob a trava do seu endereço, então uma leitura nunca vê metade de uma
+    // escrita de palavra no mesmo endereço. Palavras sobrepostas em endereços diferentes
+    // (ex.: 0x100 e 0x101) não são atômicas entre si. Essas escritas não marcam páginas sujas.
+    std::uint8_t getByteAtomico(std::size_t endereco_byte) const;
+    void setByteAtomico(std::size_t endereco_byte, std::uint8_t valor);
+    std::uint32_t lerPalavraAtomica(std::size_t endereco_byte) const;
+    void escreverPalavraAtomica(std::size_t endereco_byte, std::uint32_t valor);
+
+    // Páginas escritas desde a última limpeza/restauração
+    const std::vector<std::uint32_t>& getPaginasSujas() const {
+        return m_paginas_sujas;
+    }
+    void limparPaginasSujas();
+
+    // Registro de escritas de byte feitas por setByte/write, na ordem em que ocorreram.
+    // Com 'limite', quem consulta (ex.: a GUI) troca uma execução longa por um único
+    // aviso de transbordamento, e aí deve considerar a memória inteira alterada.
+    void setRegistroEscritas(bool ativo, std::size_t limite = SIZE_MAX) {
+        m_registrar = ativo;
+        m_limite_registro = limite;
     }
-    
-    // NOVO ACCESSOR PARA A GUI
-    const std::vector<std::uint8_t>& getMBytes() const {
-        return m_bytes;
+    const std::vector<std::uint32_t>& getRegistroEscritas() const { return m_registro_escritas; }
+    bool registroTransbordou() const { return m_registro_transbordou; }
+    void limparRegistroEscritas() {
+        m_registro_escritas.clear();
+        m_registro_transbordou = false;
     }
+
+    // Diário de desfazer: cada escrita de setByte/write/escreverBytes/preencherBytes anota
+    // em 'diario', antes de escrever, (endereço << 8) | byte antigo, na ordem das escritas.
+    // Endereços até 24 bits, como os do SIC/XE. As escritas atômicas não são anotadas.
+    void setDiarioDesfazer(std::vector<std::uint32_t>* diario) { m_diario_desfazer = diario; }
+
+    // Daqui em diante a primeira escrita em cada página a duplica, como se todas fossem
+    // compartilhadas. Chame antes de copiar (ou de deixar copiar) uma Memoria que vai
+    // continuar sendo escrita: a cópia não desmarca as páginas da origem.
+    void compartilharPaginas() { std::fill(m_exclusivas.marcas.begin(), m_exclusivas.marcas.end(), 0); }
+
+    // Passa a ver as mesmas páginas de 'origem' (do mesmo tamanho), compartilhadas com cópia
+    // na escrita. Só as páginas diferentes são trocadas, e contam como escritas (página
+    // suja e registro de escritas); custa uma comparação por página, não uma cópia.
+    // 'origem' só é lida (ver compartilharPaginas).
+    void copiarPaginasDe(const Memoria& origem);
+
+    // Volta as páginas sujas para as de 'base' (compartilhando-as) e zera as marcas.
+    // 'base' deve ter o mesmo tamanho e as marcas devem ter sido limpas
+    // no momento em que 'base' foi capturada. 'base' só é lida: várias threads podem
+    // restaurar da mesma.
+    void restaurarPaginasSujas(const Memoria& base);
 };
 
 
-#endif //VM_SIC_MEMORY_H a
\ No newline at end of file
+#endif //VM_SIC_MEMORY_H
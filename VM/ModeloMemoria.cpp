@@ -0,0 +1,157 @@
+#include "ModeloMemoria.h"
+#include <algorithm>
+#include <QColor>
+#include <QString>
+#include <QVector>
+
+ModeloMemoria::ModeloMemoria(const Memoria& memoria, QObject *parent)
+    : QAbstractTableModel(parent), m_memoria(memoria)
+{
+}
+
+int ModeloMemoria::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_memoria.getTamanhoBytes() / 3);
+}
+
+int ModeloMemoria::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : NUM_COLUNAS;
+}
+
+/*
+=========================================================================================
+Formata uma célula no momento em que a view a pinta.
+=========================================================================================
+*/
+QVariant ModeloMemoria::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    const int linha = index.row();
+    if (role == Qt::BackgroundRole) {
+        return linha == m_linha_pc ? QVariant(QColor(170, 200, 255)) : QVariant();
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    const std::size_t byte_addr = static_cast<std::size_t>(linha) * 3;
+    if (index.column() == COL_ENDERECO) {
+        return QString("0x%1").arg(byte_addr, 4, 16, QChar('0')).toUpper();
+    }
+
+    std::uint32_t palavra;
+    if (m_executando) {
+        if (!m_instantaneo || byte_addr < m_instantaneo->inicio_janela ||
+            byte_addr + 3 > std::size_t{m_instantaneo->inicio_janela} + m_instantaneo->bytes_janela) {
+            return QVariant();
+        }
+        const std::uint8_t *b = m_instantaneo->janela.data() + (byte_addr - m_instantaneo->inicio_janela);
+        palavra = (b[0] << 16) | (b[1] << 8) | b[2];
+    } else {
+        palavra = (m_memoria.getByte(byte_addr) << 16) |
+                  (m_memoria.getByte(byte_addr + 1) << 8) |
+                   m_memoria.getByte(byte_addr + 2);
+    }
+    return QString("0x%1").arg(palavra, 6, 16, QChar('0')).toUpper();
+}
+
+QVariant ModeloMemoria::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    return section == COL_ENDERECO ? QString("Endereço") : QString("Valor");
+}
+
+void ModeloMemoria::setPC(std::int32_t pc)
+{
+    const int nova = (pc >= 0 && static_cast<std::size_t>(pc) < m_memoria.getTamanhoBytes())
+                         ? linhaDoEndereco(static_cast<std::size_t>(pc)) : -1;
+    if (nova == m_linha_pc) {
+        return;
+    }
+
+    const int antiga = m_linha_pc;
+    m_linha_pc = nova;
+    const QVector<int> papeis{Qt::BackgroundRole};
+    if (antiga >= 0) {
+        emit dataChanged(index(antiga, 0), index(antiga, NUM_COLUNAS - 1), papeis);
+    }
+    if (nova >= 0) {
+        emit dataChanged(index(nova, 0), index(nova, NUM_COLUNAS - 1), papeis);
+    }
+}
+
+void ModeloMemoria::setExecutando(bool executando)
+{
+    m_instantaneo = nullptr;
+    if (executando != m_executando) {
+        m_executando = executando;
+        atualizarTudo();
+    }
+}
+
+void ModeloMemoria::setInstantaneo(const InstantaneoVM *instantaneo)
+{
+    // As linhas que saíram da janela ficam vazias e as que entraram ganham valor
+    const InstantaneoVM *anterior = m_instantaneo;
+    m_instantaneo = instantaneo;
+    atualizarJanela(anterior);
+    atualizarJanela(instantaneo);
+}
+
+void ModeloMemoria::atualizarJanela(const InstantaneoVM *instantaneo)
+{
+    if (!instantaneo || instantaneo->bytes_janela < 3) {
+        return;
+    }
+    const int primeira = linhaDoEndereco(instantaneo->inicio_janela);
+    const int ultima = std::min(rowCount() - 1,
+                                linhaDoEndereco(instantaneo->inicio_janela + instantaneo->bytes_janela - 1));
+    if (primeira <= ultima) {
+        emit dataChanged(index(primeira, COL_VALOR), index(ultima, COL_VALOR), {Qt::DisplayRole});
+    }
+}
+
+void ModeloMemoria::atualizarTudo()
+{
+    const int linhas = rowCount();
+    if (linhas > 0) {
+        // A view só busca de novo as células visíveis
+        emit dataChanged(index(0, 0), index(linhas - 1, NUM_COLUNAS - 1), {Qt::DisplayRole});
+    }
+}
+
+/*
+=========================================================================================
+Converte os endereços escritos em linhas e avisa a view em faixas contíguas de linhas.
+=========================================================================================
+*/
+void ModeloMemoria::atualizarEnderecos(const std::vector<std::uint32_t>& enderecos)
+{
+    const int linhas = rowCount();
+    m_linhas.clear();
+    for (std::uint32_t endereco : enderecos) {
+        const int linha = linhaDoEndereco(endereco);
+        // Escritas de palavra chegam como 3 bytes seguidos da mesma linha
+        if (linha < linhas && (m_linhas.empty() || m_linhas.back() != linha)) {
+            m_linhas.push_back(linha);
+        }
+    }
+    std::sort(m_linhas.begin(), m_linhas.end());
+    m_linhas.erase(std::unique(m_linhas.begin(), m_linhas.end()), m_linhas.end());
+
+    const QVector<int> papeis{Qt::DisplayRole};
+    for (std::size_t i = 0; i < m_linhas.size();) {
+        std::size_t j = i + 1;
+        while (j < m_linhas.size() && m_linhas[j] == m_linhas[j - 1] + 1) {
+            ++j;
+        }
+        emit dataChanged(index(m_linhas[i], 0), index(m_linhas[j - 1], NUM_COLUNAS - 1), papeis);
+        i = j;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef VM_SIC_MODELOMEMORIA_H
+#define VM_SIC_MODELOMEMORIA_H
+
+#include <QAbstractTableModel>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Memoria.h"
+#include "ExecutorVM.h"
+
+// Modelo da tabela de memória da GUI: uma linha por palavra, formatada só quando a
+// view pede (isto é, só para as linhas visíveis). Nada é copiado da Memoria, então o
+// custo de abrir a janela não depende do tamanho da memória.
+class ModeloMemoria : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Coluna { COL_ENDERECO = 0, COL_VALOR = 1, NUM_COLUNAS };
+
+    explicit ModeloMemoria(const Memoria& memoria, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Linha da palavra que contém o byte 'endereco'
+    static int linhaDoEndereco(std::size_t endereco) { return static_cast<int>(endereco / 3); }
+
+    // Move o destaque do PC, repintando só a linha antiga e a nova
+    void setPC(std::int32_t pc);
+    // O conteúdo de toda a memória pode ter mudado (carga, registro transbordado)
+    void atualizarTudo();
+    // Enquanto a máquina executa em outra thread, a coluna de valores vem do último
+    // instantâneo (só a janela copiada; o resto fica vazio) em vez da memória que está
+    // sendo escrita. 'instantaneo' deve continuar válido até a próxima chamada.
+    void setExecutando(bool executando);
+    void setInstantaneo(const InstantaneoVM *instantaneo);
+    // Repinta só as linhas que contêm os bytes escritos (registro de escritas da Memoria)
+    void atualizarEnderecos(const std::vector<std::uint32_t>& enderecos);
+
+private:
+    const Memoria& m_memoria;
+    int m_linha_pc = -1;
+    bool m_executando = false;
+    const InstantaneoVM *m_instantaneo = nullptr;
+
+    void atualizarJanela(const InstantaneoVM *instantaneo);
+    std::vector<int> m_linhas; // reaproveitado entre chamadas de atualizarEnderecos
+};
+
+#endif //VM_SIC_MODELOMEMORIA_H
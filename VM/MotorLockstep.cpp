@@ -0,0 +1,561 @@
+#include "MotorLockstep.h"
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*
+=========================================================================================
+Kernels sobre todas as lanes. A aritmética é feita em 32 bits sem sinal, como a da
+Maquina escalar depois do wrap. Os laços genéricos são vetorizados pelo compilador
+(SSE2 no x86-64 padrão); com -mavx2 as operações mais frequentes usam AVX2 diretamente.
+Lanes inativas também são calculadas: o resultado delas é descartado.
+=========================================================================================
+*/
+namespace {
+
+template <typename Op>
+void aplicar(std::int32_t* destino, const std::int32_t* fonte, std::size_t n, Op op) {
+    for (std::size_t l = 0; l < n; ++l) {
+        destino[l] = static_cast<std::int32_t>(op(static_cast<std::uint32_t>(destino[l]), static_cast<std::uint32_t>(fonte[l])));
+    }
+}
+
+void somar(std::int32_t* destino, const std::int32_t* fonte, std::size_t n) {
+    std::size_t l = 0;
+#if defined(__AVX2__)
+    for (; l + 8 <= n; l += 8) {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(destino + l));
+        __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(fonte + l));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destino + l), _mm256_add_epi32(d, f));
+    }
+#endif
+    aplicar(destino + l, fonte + l, n - l, [](std::uint32_t d, std::uint32_t f) { return d + f; });
+}
+
+void subtrair(std::int32_t* destino, const std::int32_t* fonte, std::size_t n) {
+    std::size_t l = 0;
+#if defined(__AVX2__)
+    for (; l + 8 <= n; l += 8) {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(destino + l));
+        __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(fonte + l));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destino + l), _mm256_sub_epi32(d, f));
+    }
+#endif
+    aplicar(destino + l, fonte + l, n - l, [](std::uint32_t d, std::uint32_t f) { return d - f; });
+}
+
+// sw = -1/0/1 conforme a comparação de a com b (com ou sem sinal, como na Maquina)
+void comparar(std::int32_t* sw, const std::int32_t* a, const std::int32_t* b, std::size_t n, bool sem_sinal) {
+    std::size_t l = 0;
+#if defined(__AVX2__)
+    // sem sinal: inverter o bit de sinal transforma a comparação em uma com sinal
+    const __m256i vies = _mm256_set1_epi32(sem_sinal ? static_cast<std::int32_t>(0x80000000u) : 0);
+    for (; l + 8 <= n; l += 8) {
+        __m256i va = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + l)), vies);
+        __m256i vb = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + l)), vies);
+        __m256i maior = _mm256_cmpgt_epi32(va, vb); // -1 onde a > b
+        __m256i menor = _mm256_cmpgt_epi32(vb, va); // -1 onde a < b
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(sw + l), _mm256_sub_epi32(menor, maior));
+    }
+#endif
+    for (; l < n; ++l) {
+        if (sem_sinal) {
+            std::uint32_t ua = static_cast<std::uint32_t>(a[l]), ub = static_cast<std::uint32_t>(b[l]);
+            sw[l] = (ua > ub) - (ua < ub);
+        } else {
+            sw[l] = (a[l] > b[l]) - (a[l] < b[l]);
+        }
+    }
+}
+
+} // namespace
+
+MotorLockstep::MotorLockstep(std::shared_ptr<const ImagemCompartilhada> imagem,
+                             const std::vector<Registradores>& estados,
+                             std::size_t tamanho_memoria)
+    : m_lanes(estados.size()), m_tamanho(tamanho_memoria * 3), m_num_ativas(estados.size()), m_iniciais(estados) {
+    for (auto& r : m_regs) {
+        r.resize(m_lanes);
+    }
+    m_sw.resize(m_lanes);
+    m_ativa.assign(m_lanes, 1);
+    m_alvo.resize(m_lanes);
+    m_operando.resize(m_lanes);
+    m_mem.assign(m_tamanho * m_lanes, 0);
+
+    for (std::size_t l = 0; l < m_lanes; ++l) {
+        const Registradores& r = estados[l];
+        m_regs[RegID::A][l] = r.A;
+        m_regs[RegID::X][l] = r.X;
+        m_regs[RegID::L][l] = r.L;
+        m_regs[RegID::B][l] = r.B;
+        m_regs[RegID::S][l] = r.S;
+        m_regs[RegID::T][l] = r.T;
+        m_sw[l] = r.SW;
+    }
+    if (m_lanes > 0) {
+        m_pc = estados[0].PC;
+    }
+
+    if (imagem) {
+        std::size_t n = std::min(imagem->getTamanho(), m_tamanho);
+        for (std::size_t a = 0; a < n; ++a) {
+            std::uint8_t valor = (*imagem->getPaginas()[a >> PAGINA_BITS])[a & PAGINA_MASCARA];
+            std::fill_n(m_mem.begin() + a * m_lanes, m_lanes, valor);
+        }
+    }
+}
+
+void MotorLockstep::setByte(std::size_t lane, std::size_t endereco_byte, std::uint8_t valor) {
+    if (lane < m_lanes && endereco_byte < m_tamanho) {
+        m_mem[endereco_byte * m_lanes + lane] = valor;
+    }
+}
+
+std::int32_t* MotorLockstep::reg(std::uint8_t num) {
+    switch (num) {
+        case RegID::A: case RegID::X: case RegID::L:
+        case RegID::B: case RegID::S: case RegID::T:
+            return m_regs[num].data();
+        default:
+            return nullptr;
+    }
+}
+
+std::size_t MotorLockstep::primeiraAtiva() const {
+    return static_cast<std::size_t>(std::find(m_ativa.begin(), m_ativa.end(), 1) - m_ativa.begin());
+}
+
+// mesmas regras de limite que os lambdas de Maquina::passo()
+std::uint32_t MotorLockstep::lerPalavra(std::size_t lane, std::uint32_t endereco) const {
+    if (endereco + std::size_t{2} >= m_tamanho) {
+        return 0;
+    }
+    const std::uint8_t* m = m_mem.data() + lane;
+    return (m[endereco * m_lanes] << 16) | (m[(endereco + 1) * m_lanes] << 8) | m[(endereco + 2) * m_lanes];
+}
+
+void MotorLockstep::escreverPalavra(std::size_t lane, std::uint32_t endereco, std::uint32_t valor) {
+    for (std::size_t k = 0; k < 3; ++k) {
+        std::size_t a = std::size_t{endereco} + k;
+        if (a < m_tamanho) {
+            m_mem[a * m_lanes + lane] = (valor >> (16 - 8 * k)) & 0xFF;
+        }
+    }
+}
+
+/*
+=========================================================================================
+Tirar uma lane do grupo e terminar a execução dela em uma Maquina escalar, a partir
+do estado atual (a instrução corrente ainda não foi executada).
+=========================================================================================
+*/
+void MotorLockstep::desviar(std::size_t lane) {
+    Maquina vm(m_tamanho / 3);
+    vm.setLog(nullptr);
+
+    Memoria& memoria = vm.getMemoria();
+    for (std::size_t a = 0; a < m_tamanho; ++a) {
+        std::uint8_t valor = m_mem[a * m_lanes + lane];
+        if (valor) {
+            memoria.setByte(a, valor); // páginas só com zeros continuam compartilhadas
+        }
+    }
+
+    Registradores& r = vm.getCPU().r;
+    r = m_iniciais[lane];
+    r.A = m_regs[RegID::A][lane];
+    r.X = m_regs[RegID::X][lane];
+    r.L = m_regs[RegID::L][lane];
+    r.B = m_regs[RegID::B][lane];
+    r.S = m_regs[RegID::S][lane];
+    r.T = m_regs[RegID::T][lane];
+    r.SW = static_cast<status>(m_sw[lane]);
+    r.PC = m_pc;
+
+    ResultadoLote& resultado = m_resultados[lane];
+    resultado.falha = vm.executar(m_limite - m_executadas);
+    resultado.erro = vm.getErro();
+    resultado.instrucoes = m_executadas + vm.getContadorInstrucoes();
+    resultado.regs = r;
+    for (const auto& [inicio, tamanho] : *m_faixas) {
+        std::size_t ini = std::min(inicio, memoria.getTamanhoBytes());
+        std::size_t fim = std::min(ini + tamanho, memoria.getTamanhoBytes());
+        resultado.faixas.push_back(memoria.getBytes(ini, fim - ini));
+    }
+
+    m_ativa[lane] = 0;
+    --m_num_ativas;
+}
+
+void MotorLockstep::desviarTodas() {
+    for (std::size_t l = 0; l < m_lanes; ++l) {
+        if (m_ativa[l]) {
+            desviar(l);
+        }
+    }
+}
+
+// Encerrar uma lane que terminou dentro do grupo
+void MotorLockstep::concluir(std::size_t lane, Falha falha, std::int32_t pc) {
+    ResultadoLote& resultado = m_resultados[lane];
+    resultado.falha = falha;
+    resultado.instrucoes = m_executadas;
+
+    Registradores& r = resultado.regs;
+    r.A = m_regs[RegID::A][lane];
+    r.X = m_regs[RegID::X][lane];
+    r.L = m_regs[RegID::L][lane];
+    r.B = m_regs[RegID::B][lane];
+    r.S = m_regs[RegID::S][lane];
+    r.T = m_regs[RegID::T][lane];
+    r.SW = static_cast<status>(m_sw[lane]);
+    r.PC = pc;
+
+    for (const auto& [inicio, tamanho] : *m_faixas) {
+        std::size_t ini = std::min(inicio, m_tamanho);
+        std::size_t fim = std::min(ini + tamanho, m_tamanho);
+        std::vector<std::uint8_t> bytes(fim - ini);
+        for (std::size_t a = ini; a < fim; ++a) {
+            bytes[a - ini] = m_mem[a * m_lanes + lane];
+        }
+        resultado.faixas.push_back(std::move(bytes));
+    }
+
+    m_ativa[lane] = 0;
+    --m_num_ativas;
+}
+
+std::vector<ResultadoLote> MotorLockstep::executar(std::uint64_t limite_instrucoes,
+                                                   const std::vector<std::pair<std::size_t, std::size_t>>& faixas) {
+    m_resultados.assign(m_lanes, ResultadoLote{});
+    m_limite = limite_instrucoes;
+    m_faixas = &faixas;
+    m_executadas = 0;
+
+    // o grupo segue o PC da lane 0: as que começam em outro PC vão direto para a Maquina escalar
+    const std::int32_t pc_grupo = m_pc;
+    for (std::size_t l = 0; l < m_lanes; ++l) {
+        if (m_ativa[l] && m_iniciais[l].PC != pc_grupo) {
+            m_pc = m_iniciais[l].PC;
+            desviar(l);
+        }
+    }
+    m_pc = pc_grupo;
+
+    while (m_num_ativas > 0) {
+        if (m_executadas >= m_limite) {
+            for (std::size_t l = 0; l < m_lanes; ++l) {
+                if (m_ativa[l]) {
+                    concluir(l, Falha::LIMITE_INSTRUCOES, m_pc);
+                }
+            }
+            break;
+        }
+        passo();
+    }
+
+    m_faixas = nullptr;
+    return std::move(m_resultados);
+}
+
+/*
+=========================================================================================
+Obter o operando de cada lane em m_operando a partir dos endereços em m_alvo,
+com as mesmas regras de Maquina::passo() (leituras fora dos limites valem 0).
+=========================================================================================
+*/
+void MotorLockstep::calcularOperando(const InstrucaoDecodificada& inst) {
+    const std::size_t N = m_lanes;
+
+    // i==1 então Imediato
+    if (inst.i) {
+        std::copy_n(reinterpret_cast<const std::int32_t*>(m_alvo.data()), N, m_operando.data());
+        return;
+    }
+
+    const bool uniforme = !inst.x && !inst.b;
+    if (uniforme && !inst.n) {
+        // mesmo endereço em todas as lanes: três faixas contíguas da memória intercalada
+        std::size_t a = m_alvo[0];
+        if (a + 2 >= m_tamanho) {
+            std::fill_n(m_operando.begin(), N, 0);
+            return;
+        }
+        const std::uint8_t* b1 = m_mem.data() + a * N;
+        const std::uint8_t* b2 = b1 + N;
+        const std::uint8_t* b3 = b2 + N;
+        for (std::size_t l = 0; l < N; ++l) {
+            m_operando[l] = (b1[l] << 16) | (b2[l] << 8) | b3[l];
+        }
+        return;
+    }
+
+    for (std::size_t l = 0; l < N; ++l) {
+        std::uint32_t endereco = m_alvo[l];
+        // endereço de um ponteiro
+        if (inst.n) {
+            endereco = lerPalavra(l, endereco);
+        }
+        m_operando[l] = static_cast<std::int32_t>(lerPalavra(l, endereco));
+    }
+}
+
+/*
+=========================================================================================
+Executar a instrução do PC comum para todas as lanes ativas.
+=========================================================================================
+*/
+void MotorLockstep::passo() {
+    const std::size_t N = m_lanes;
+    const std::size_t pc_inicial = static_cast<std::uint32_t>(m_pc);
+
+    // fim de programa e erros de busca ficam a cargo da Maquina escalar
+    if (pc_inicial + 3 >= m_tamanho) {
+        desviarTodas();
+        return;
+    }
+
+    // o código pode ter sido alterado em só algumas lanes
+    const std::size_t ref = primeiraAtiva();
+    std::uint8_t bytes[4];
+    for (std::size_t k = 0; k < 4; ++k) {
+        bytes[k] = m_mem[(pc_inicial + k) * N + ref];
+    }
+    for (std::size_t l = ref + 1; l < N; ++l) {
+        if (!m_ativa[l]) continue;
+        for (std::size_t k = 0; k < 4; ++k) {
+            if (m_mem[(pc_inicial + k) * N + l] != bytes[k]) {
+                desviar(l);
+                break;
+            }
+        }
+    }
+
+    const InstrucaoDecodificada inst = decodificar(bytes[0], bytes[1], bytes[2], bytes[3]);
+    const std::uint8_t opcode = inst.opcode;
+
+    // Formato 1: RSUB encerra todas as lanes
+    if (inst.formato == Formato::F1) {
+        if (opcode != 0x4C) { // FLOAT/FIX/NORM: o F fica com a Maquina escalar
+            desviarTodas();
+            return;
+        }
+        ++m_executadas;
+        for (std::size_t l = 0; l < N; ++l) {
+            if (m_ativa[l]) {
+                concluir(l, Falha::NENHUMA, m_regs[RegID::L][l]);
+            }
+        }
+        return;
+    }
+
+    // Formato 2: registrador inválido não altera nada (como o catch de passo())
+    if (inst.formato == Formato::F2) {
+        if (opcode == 0xB0 || opcode == 0xE4) { // SVC e HCALL ficam com a Maquina escalar
+            desviarTodas();
+            return;
+        }
+        ++m_executadas;
+        m_pc += 2;
+        std::int32_t* r1 = reg(inst.r1);
+        std::int32_t* r2 = reg(inst.r2);
+        if (!r1) return;
+
+        switch (opcode) {
+            case 0x04: // CLEAR r1
+                std::fill_n(r1, N, 0);
+                break;
+            case 0x90: // ADDR r1, r2
+                if (r2) somar(r2, r1, N);
+                break;
+            case 0x98: // MULR r1, r2
+                if (r2) aplicar(r2, r1, N, [](std::uint32_t d, std::uint32_t f) { return d * f; });
+                break;
+            case 0xAC: // RMO r1, r2
+                if (r2) std::copy_n(r1, N, r2);
+                break;
+            case 0xA0: // COMPR r1, r2
+                if (r2) comparar(m_sw.data(), r1, r2, N, false);
+                break;
+            case 0x9C: // DIVR r1, r2
+                if (!r2) break;
+                for (std::size_t l = 0; l < N; ++l) {
+                    if (m_ativa[l] && r1[l] != 0) r2[l] /= r1[l];
+                }
+                break;
+            case 0xA4: { // SHIFTL r1, n
+                int shift_amount = inst.r2 + 1;
+                for (std::size_t l = 0; l < N; ++l) r1[l] = static_cast<std::uint32_t>(r1[l]) << shift_amount;
+                break;
+            }
+            case 0xA8: { // SHIFTR r1, n
+                int shift_amount = inst.r2 + 1;
+                for (std::size_t l = 0; l < N; ++l) r1[l] >>= shift_amount;
+                break;
+            }
+            case 0x94: // SUBR r1, r2
+                if (r2) subtrair(r2, r1, N);
+                break;
+            case 0xB8: { // TIXR r1
+                std::int32_t* x = m_regs[RegID::X].data();
+                for (std::size_t l = 0; l < N; ++l) x[l] = static_cast<std::uint32_t>(x[l]) + 1;
+                comparar(m_sw.data(), x, r1, N, false);
+                break;
+            }
+            case 0xBC: // IDCPU r1 (cada lane é uma máquina de uma CPU só)
+                std::fill_n(r1, N, 0);
+                break;
+        }
+        return;
+    }
+
+    // Formato 3/4: só os opcodes abaixo são executados em grupo
+    switch (opcode) {
+        case 0x00: case 0x18: case 0x40: case 0x28: case 0x24: case 0x68: case 0x08:
+        case 0x6C: case 0x74: case 0x20: case 0x44: case 0x1C: case 0x2C: // carga/ALU
+        case 0x0C: case 0x78: case 0x14: case 0x7C: case 0x84: case 0x10: // armazenamento
+        case 0x50: case 0x54:                                             // LDCH/STCH
+        case 0x3C: case 0x30: case 0x34: case 0x38: case 0x48:            // desvios
+            break;
+        default:
+            desviarTodas(); // a Maquina escalar reporta o opcode inválido
+            return;
+    }
+
+    const std::int32_t pc_seguinte = m_pc + static_cast<std::int32_t>(inst.tamanho);
+    const std::uint32_t disp = static_cast<std::uint32_t>(inst.disp);
+
+    // Endereço alvo por lane
+    if (inst.formato == Formato::F4 || (!inst.p && !inst.b)) {
+        std::fill_n(m_alvo.begin(), N, disp);
+    } else if (inst.p) { // PC-relative
+        std::fill_n(m_alvo.begin(), N, static_cast<std::uint32_t>(pc_seguinte) + disp);
+    } else { // Base-relative
+        const std::int32_t* base = m_regs[RegID::B].data();
+        for (std::size_t l = 0; l < N; ++l) m_alvo[l] = static_cast<std::uint32_t>(base[l]) + disp;
+    }
+    // Endereçamento indexado
+    if (inst.x) {
+        const std::int32_t* x = m_regs[RegID::X].data();
+        for (std::size_t l = 0; l < N; ++l) m_alvo[l] += static_cast<std::uint32_t>(x[l]);
+    }
+
+    // Desvios: as lanes que não seguem o mesmo caminho da maioria são desviadas
+    if (opcode == 0x3C || opcode == 0x30 || opcode == 0x34 || opcode == 0x38 || opcode == 0x48) {
+        auto proximo_pc = [&](std::size_t l) -> std::int32_t {
+            bool salta = opcode == 0x3C || opcode == 0x48 ||
+                         (opcode == 0x30 && m_sw[l] == EQUAL) ||
+                         (opcode == 0x34 && m_sw[l] == BIGGER) ||
+                         (opcode == 0x38 && m_sw[l] == SMALLER);
+            return salta ? static_cast<std::int32_t>(m_alvo[l]) : pc_seguinte;
+        };
+
+        // dois candidatos: o caminho da primeira lane e o primeiro caminho diferente dele
+        std::int32_t candidato1 = proximo_pc(primeiraAtiva());
+        std::int32_t candidato2 = candidato1;
+        std::size_t votos1 = 0, votos2 = 0;
+        for (std::size_t l = 0; l < N; ++l) {
+            if (!m_ativa[l]) continue;
+            std::int32_t destino = proximo_pc(l);
+            if (destino == candidato1) {
+                ++votos1;
+            } else {
+                if (votos2 == 0) candidato2 = destino;
+                if (destino == candidato2) ++votos2;
+            }
+        }
+        const std::int32_t escolhido = votos1 >= votos2 ? candidato1 : candidato2;
+        for (std::size_t l = 0; l < N; ++l) {
+            if (m_ativa[l] && proximo_pc(l) != escolhido) {
+                desviar(l);
+            }
+        }
+        if (m_num_ativas == 0) return;
+
+        ++m_executadas;
+        if (opcode == 0x48) { // JSUB m
+            std::fill_n(m_regs[RegID::L].begin(), N, pc_seguinte);
+        }
+        m_pc = escolhido;
+        return;
+    }
+
+    ++m_executadas;
+    m_pc = pc_seguinte;
+
+    std::int32_t* A = m_regs[RegID::A].data();
+    const std::int32_t* op = m_operando.data();
+
+    // Armazenamentos vão sempre para o endereço alvo, como em passo()
+    auto armazenar = [&](const std::int32_t* valor) {
+        if (!inst.x && !inst.b) {
+            std::uint32_t a = m_alvo[0];
+            for (std::size_t k = 0; k < 3; ++k) {
+                std::size_t endereco = std::size_t{a} + k;
+                if (endereco >= m_tamanho) break;
+                std::uint8_t* destino = m_mem.data() + endereco * N;
+                const int deslocamento = 16 - 8 * static_cast<int>(k);
+                for (std::size_t l = 0; l < N; ++l) destino[l] = (static_cast<std::uint32_t>(valor[l]) >> deslocamento) & 0xFF;
+            }
+            return;
+        }
+        for (std::size_t l = 0; l < N; ++l) {
+            if (m_ativa[l]) escreverPalavra(l, m_alvo[l], static_cast<std::uint32_t>(valor[l]));
+        }
+    };
+
+    switch (opcode) {
+        case 0x0C: armazenar(A); return;                             // STA m
+        case 0x78: armazenar(m_regs[RegID::B].data()); return;       // STB m
+        case 0x14: armazenar(m_regs[RegID::L].data()); return;       // STL m
+        case 0x7C: armazenar(m_regs[RegID::S].data()); return;       // STS m
+        case 0x84: armazenar(m_regs[RegID::T].data()); return;       // STT m
+        case 0x10: armazenar(m_regs[RegID::X].data()); return;       // STX m
+        case 0x50: { // LDCH m
+            for (std::size_t l = 0; l < N; ++l) {
+                if (m_ativa[l] && m_alvo[l] < m_tamanho) {
+                    A[l] = (A[l] & 0xFFFF00) | m_mem[std::size_t{m_alvo[l]} * N + l];
+                }
+            }
+            return;
+        }
+        case 0x54: { // STCH m
+            for (std::size_t l = 0; l < N; ++l) {
+                if (m_ativa[l] && m_alvo[l] < m_tamanho) {
+                    m_mem[std::size_t{m_alvo[l]} * N + l] = A[l] & 0xFF;
+                }
+            }
+            return;
+        }
+    }
+
+    calcularOperando(inst);
+
+    switch (opcode) {
+        case 0x00: std::copy_n(op, N, A); break;                              // LDA m
+        case 0x68: std::copy_n(op, N, m_regs[RegID::B].begin()); break;       // LDB m
+        case 0x08: std::copy_n(op, N, m_regs[RegID::L].begin()); break;       // LDL m
+        case 0x6C: std::copy_n(op, N, m_regs[RegID::S].begin()); break;       // LDS m
+        case 0x74: std::copy_n(op, N, m_regs[RegID::T].begin()); break;       // LDT m
+        case 0x18: somar(A, op, N); break;                                    // ADD m
+        case 0x1C: subtrair(A, op, N); break;                                 // SUB m
+        case 0x20: aplicar(A, op, N, [](std::uint32_t d, std::uint32_t f) { return d * f; }); break; // MUL m
+        case 0x40: aplicar(A, op, N, [](std::uint32_t d, std::uint32_t f) { return d & f; }); break; // AND m
+        case 0x44: aplicar(A, op, N, [](std::uint32_t d, std::uint32_t f) { return d | f; }); break; // OR m
+        case 0x24: // DIV m (divisor zero: A não muda)
+            aplicar(A, op, N, [](std::uint32_t d, std::uint32_t f) { return f ? d / f : d; });
+            break;
+        case 0x28: // COMP m (sem sinal, como em passo())
+            comparar(m_sw.data(), A, op, N, true);
+            break;
+        case 0x2C: { // TIX m
+            std::int32_t* x = m_regs[RegID::X].data();
+            for (std::size_t l = 0; l < N; ++l) x[l] = static_cast<std::uint32_t>(x[l]) + 1;
+            comparar(m_sw.data(), x, op, N, true);
+            break;
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef VM_SIC_MOTORLOCKSTEP_H
+#define VM_SIC_MOTORLOCKSTEP_H
+
+#include "BatchRunner.h"
+
+// Executa o mesmo programa para N entradas ao mesmo tempo, uma "lane" por entrada.
+// Os registradores ficam em estrutura de arrays (um vetor por registrador) e a memória
+// é intercalada por lane (byte 'a' da lane 'l' em a * N + l), de modo que cada instrução
+// vira um laço sobre as lanes que o compilador vetoriza. Quando as lanes discordam sobre
+// o próximo PC, as da minoria são desviadas para uma Maquina escalar e seguem sozinhas.
+// O grupo começa no PC da primeira lane; lanes com outro PC inicial rodam desde o início
+// na Maquina escalar.
+//
+// A memória ocupa N vezes o tamanho pedido: escolha 'tamanho_memoria' de acordo.
+class MotorLockstep {
+private:
+    std::size_t m_lanes;
+    std::size_t m_tamanho;              // bytes por lane
+    std::int32_t m_pc = 0;              // comum a todas as lanes ativas
+    std::vector<std::int32_t> m_regs[6]; // A, X, L, B, S, T (índice = RegID)
+    std::vector<std::int32_t> m_sw;
+    std::vector<std::uint8_t> m_mem;
+    std::vector<std::uint8_t> m_ativa;
+    std::size_t m_num_ativas;
+    std::vector<Registradores> m_iniciais; // modo/máscara não mudam dentro do grupo (LPS desvia)
+
+    // estado da execução em andamento
+    std::uint64_t m_executadas = 0;
+    std::uint64_t m_limite = 0;
+    const std::vector<std::pair<std::size_t, std::size_t>>* m_faixas = nullptr;
+    std::vector<ResultadoLote> m_resultados;
+
+    // área de trabalho por lane, reaproveitada a cada instrução
+    std::vector<std::uint32_t> m_alvo;
+    std::vector<std::int32_t> m_operando;
+
+    std::int32_t* reg(std::uint8_t num);
+    std::size_t primeiraAtiva() const;
+    std::uint32_t lerPalavra(std::size_t lane, std::uint32_t endereco) const;
+    void escreverPalavra(std::size_t lane, std::uint32_t endereco, std::uint32_t valor);
+
+    void passo();
+    void calcularOperando(const InstrucaoDecodificada& inst);
+    void desviar(std::size_t lane);
+    void desviarTodas();
+    void concluir(std::size_t lane, Falha falha, std::int32_t pc);
+
+public:
+    MotorLockstep(std::shared_ptr<const ImagemCompartilhada> imagem,
+                  const std::vector<Registradores>& estados,
+                  std::size_t tamanho_memoria = MEMORIA_TAMANHO);
+
+    // Entradas específicas de cada lane
+    void setByte(std::size_t lane, std::size_t endereco_byte, std::uint8_t valor);
+
+    // Resultados na ordem dos estados iniciais, no mesmo formato do BatchRunner
+    std::vector<ResultadoLote> executar(std::uint64_t limite_instrucoes,
+                                        const std::vector<std::pair<std::size_t, std::size_t>>& faixas = {});
+};
+
+#endif //VM_SIC_MOTORLOCKSTEP_H
@@ -0,0 +1,230 @@
+#include "PainelDesempenho.h"
+#include <QHeaderView>
+#include <QPainter>
+#include <QPainterPath>
+#include <QVBoxLayout>
+#include <algorithm>
+#include "Decodificador.h"
+
+GraficoMIPS::GraficoMIPS(QWidget *parent) : QWidget(parent)
+{
+    setMinimumHeight(100);
+}
+
+void GraficoMIPS::adicionar(double mips)
+{
+    m_amostras.push_back(mips);
+    if (m_amostras.size() > MAX_AMOSTRAS) {
+        m_amostras.pop_front();
+    }
+    update();
+}
+
+void GraficoMIPS::limpar()
+{
+    m_amostras.clear();
+    update();
+}
+
+void GraficoMIPS::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+    painter.setPen(palette().color(QPalette::Mid));
+    painter.drawRect(rect().adjusted(0, 0, -1, -1));
+    if (m_amostras.empty()) {
+        return;
+    }
+
+    const double maximo = std::max(1.0, *std::max_element(m_amostras.begin(), m_amostras.end()) * 1.1);
+    const double passo_x = static_cast<double>(width() - 1) / (MAX_AMOSTRAS - 1);
+    const double x0 = (width() - 1) - passo_x * (m_amostras.size() - 1); // mais recente na borda direita
+
+    QPainterPath linha;
+    for (std::size_t k = 0; k < m_amostras.size(); ++k) {
+        const QPointF ponto(x0 + passo_x * k, (height() - 1) * (1.0 - m_amostras[k] / maximo));
+        if (k == 0) {
+            linha.moveTo(ponto);
+        } else {
+            linha.lineTo(ponto);
+        }
+    }
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(QColor(40, 100, 200), 2));
+    painter.drawPath(linha);
+
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawText(rect().adjusted(4, 2, -4, -2), Qt::AlignLeft | Qt::AlignTop,
+                     QString("%1 MIPS").arg(maximo, 0, 'f', 1));
+}
+
+GraficoBarras::GraficoBarras(QWidget *parent) : QWidget(parent)
+{
+    setMinimumHeight(160);
+}
+
+void GraficoBarras::setBarras(std::vector<std::pair<QString, std::uint64_t>> barras)
+{
+    m_barras = std::move(barras);
+    update();
+}
+
+void GraficoBarras::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+    if (m_barras.empty()) {
+        return;
+    }
+
+    std::uint64_t maximo = 1;
+    for (const auto& barra : m_barras) {
+        maximo = std::max(maximo, barra.second);
+    }
+    const int largura_rotulo = fontMetrics().horizontalAdvance("COMPF") + 8;
+    const double altura = static_cast<double>(height()) / m_barras.size();
+    const int largura_util = std::max(1, width() - largura_rotulo - 4);
+
+    for (std::size_t k = 0; k < m_barras.size(); ++k) {
+        const QRectF linha(0, altura * k, width(), altura);
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(QRectF(4, linha.top(), largura_rotulo - 4, altura), Qt::AlignLeft | Qt::AlignVCenter,
+                         m_barras[k].first);
+        const double comprimento = static_cast<double>(largura_util) * m_barras[k].second / maximo;
+        painter.fillRect(QRectF(largura_rotulo, linha.top() + altura * 0.15, comprimento, altura * 0.7),
+                         QColor(170, 200, 255));
+    }
+}
+
+PainelDesempenho::PainelDesempenho(const PerfilExecucao& perfil, QWidget *parent)
+    : QWidget(parent), m_perfil(perfil)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    chkColetar = new QCheckBox("Coletar contadores (execução mais lenta)");
+    connect(chkColetar, &QCheckBox::toggled, this, &PainelDesempenho::coletaAlterada);
+    layout->addWidget(chkColetar);
+
+    lblMIPS = new QLabel("MIPS: -");
+    graficoMIPS = new GraficoMIPS();
+    layout->addWidget(lblMIPS);
+    layout->addWidget(graficoMIPS);
+
+    graficoOpcodes = new GraficoBarras();
+    layout->addWidget(new QLabel("Mistura de opcodes:"));
+    layout->addWidget(graficoOpcodes, 1);
+
+    tblPCs = new QTableWidget(static_cast<int>(PCS_QUENTES), 4);
+    tblPCs->setHorizontalHeaderLabels({"Endereço", "Execuções", "%", "Instrução"});
+    tblPCs->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    tblPCs->verticalHeader()->setVisible(false);
+    tblPCs->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    layout->addWidget(new QLabel("Endereços mais executados:"));
+    layout->addWidget(tblPCs, 1);
+}
+
+void PainelDesempenho::iniciarExecucao()
+{
+    m_relogio.start();
+    m_instrucoes_amostra = 0;
+}
+
+void PainelDesempenho::amostrar(const InstantaneoVM& instantaneo)
+{
+    if (!m_relogio.isValid() || m_relogio.elapsed() < INTERVALO_AMOSTRA_MS) {
+        return;
+    }
+    const double segundos = m_relogio.restart() / 1000.0;
+    const double mips = (instantaneo.instrucoes - m_instrucoes_amostra) / segundos / 1e6;
+    m_instrucoes_amostra = instantaneo.instrucoes;
+    graficoMIPS->adicionar(mips);
+    lblMIPS->setText(QString("MIPS: %1").arg(mips, 0, 'f', 1));
+
+    if (!chkColetar->isChecked()) {
+        return;
+    }
+    // Só há bytes para os endereços pedidos no instantâneo anterior; os novos aparecem no próximo
+    atualizarPCs(atualizarOpcodes(), [&instantaneo](std::uint32_t pc) {
+        for (std::size_t k = 0; k < instantaneo.pcs_codigo.size(); ++k) {
+            if (instantaneo.pcs_codigo[k] == pc) {
+                const auto& b = instantaneo.codigo[k];
+                return QString::fromStdString(desmontar(decodificar(b[0], b[1], b[2], b[3]), pc));
+            }
+        }
+        return QString("...");
+    });
+}
+
+void PainelDesempenho::atualizarParado(const Memoria& memoria)
+{
+    m_relogio.invalidate();
+    if (!chkColetar->isChecked()) {
+        return;
+    }
+    atualizarPCs(atualizarOpcodes(), [&memoria](std::uint32_t pc) {
+        return QString::fromStdString(desmontar(decodificar(memoria.getByte(pc), memoria.getByte(pc + 1),
+                                                            memoria.getByte(pc + 2), memoria.getByte(pc + 3)), pc));
+    });
+}
+
+void PainelDesempenho::limpar()
+{
+    m_relogio.invalidate();
+    m_pcs_quentes.clear();
+    lblMIPS->setText("MIPS: -");
+    graficoMIPS->limpar();
+    graficoOpcodes->setBarras({});
+    tblPCs->clearContents();
+}
+
+/*
+=========================================================================================
+Mistura de opcodes: os OPCODES_NO_GRAFICO mais executados. Retorna o total de instruções
+contadas, base das porcentagens.
+=========================================================================================
+*/
+std::uint64_t PainelDesempenho::atualizarOpcodes()
+{
+    std::vector<std::pair<std::uint8_t, std::uint64_t>> contagens;
+    std::uint64_t total = 0;
+    for (int opcode = 0; opcode < 256; opcode += 4) {
+        const std::uint64_t execucoes = m_perfil.execucoesDoOpcode(static_cast<std::uint8_t>(opcode));
+        if (execucoes) {
+            contagens.emplace_back(static_cast<std::uint8_t>(opcode), execucoes);
+            total += execucoes;
+        }
+    }
+    std::sort(contagens.begin(), contagens.end(),
+              [](const auto& a, const auto& b) { return a.second > b.second; });
+    if (contagens.size() > static_cast<std::size_t>(OPCODES_NO_GRAFICO)) {
+        contagens.resize(OPCODES_NO_GRAFICO);
+    }
+
+    std::vector<std::pair<QString, std::uint64_t>> barras;
+    for (const auto& [opcode, execucoes] : contagens) {
+        const char *mnemonico = infoOpcode(opcode).mnemonico;
+        barras.emplace_back(mnemonico ? QString(mnemonico) : QString("0x%1").arg(static_cast<int>(opcode), 2, 16, QChar('0')).toUpper(),
+                            execucoes);
+    }
+    graficoOpcodes->setBarras(std::move(barras));
+    return total;
+}
+
+void PainelDesempenho::atualizarPCs(std::uint64_t total, const std::function<QString(std::uint32_t)>& instrucaoEm)
+{
+    const std::vector<PerfilExecucao::PCQuente> quentes = m_perfil.maisExecutados(PCS_QUENTES);
+
+    m_pcs_quentes.clear();
+    tblPCs->clearContents();
+    for (std::size_t k = 0; k < quentes.size(); ++k) {
+        const PerfilExecucao::PCQuente& quente = quentes[k];
+        m_pcs_quentes.push_back(quente.pc);
+
+        const double porcentagem = total ? 100.0 * quente.execucoes / total : 0.0;
+        const int linha = static_cast<int>(k);
+        tblPCs->setItem(linha, 0, new QTableWidgetItem(QString("0x%1").arg(quente.pc, 4, 16, QChar('0')).toUpper()));
+        tblPCs->setItem(linha, 1, new QTableWidgetItem(QString::number(quente.execucoes)));
+        tblPCs->setItem(linha, 2, new QTableWidgetItem(QString::number(porcentagem, 'f', 1)));
+        tblPCs->setItem(linha, 3, new QTableWidgetItem(instrucaoEm(quente.pc)));
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef VM_SIC_PAINELDESEMPENHO_H
+#define VM_SIC_PAINELDESEMPENHO_H
+
+#include <QCheckBox>
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QString>
+#include <QTableWidget>
+#include <QWidget>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "ExecutorVM.h"
+#include "Memoria.h"
+#include "PerfilExecucao.h"
+
+// Linha das últimas amostras de MIPS, a mais recente à direita
+class GraficoMIPS : public QWidget
+{
+public:
+    static constexpr std::size_t MAX_AMOSTRAS = 120;
+
+    explicit GraficoMIPS(QWidget *parent = nullptr);
+    void adicionar(double mips);
+    void limpar();
+
+protected:
+    void paintEvent(QPaintEvent *evento) override;
+
+private:
+    std::deque<double> m_amostras;
+};
+
+// Barras horizontais (rótulo, valor), na ordem recebida
+class GraficoBarras : public QWidget
+{
+public:
+    explicit GraficoBarras(QWidget *parent = nullptr);
+    void setBarras(std::vector<std::pair<QString, std::uint64_t>> barras);
+
+protected:
+    void paintEvent(QPaintEvent *evento) override;
+
+private:
+    std::vector<std::pair<QString, std::uint64_t>> m_barras;
+};
+
+// Painel de desempenho: MIPS ao longo da execução, mistura de opcodes e os endereços
+// mais executados com a instrução de cada um. Os contadores vêm do PerfilExecucao que a
+// máquina preenche em passo(); durante a execução a desmontagem usa os bytes copiados no
+// InstantaneoVM (a GUI não lê a memória enquanto a máquina roda).
+class PainelDesempenho : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int INTERVALO_AMOSTRA_MS = 500;
+    static constexpr int OPCODES_NO_GRAFICO = 16;
+    static constexpr std::size_t PCS_QUENTES = InstantaneoVM::PCS_CODIGO;
+
+    explicit PainelDesempenho(const PerfilExecucao& perfil, QWidget *parent = nullptr);
+
+    // Começo de uma execução ('instrucoes' do instantâneo é relativo a ela)
+    void iniciarExecucao();
+    // Chamado a cada instantâneo; amostra a cada INTERVALO_AMOSTRA_MS
+    void amostrar(const InstantaneoVM& instantaneo);
+    // Máquina parada: contadores e desmontagem direto da memória
+    void atualizarParado(const Memoria& memoria);
+    void limpar();
+
+    // Endereços mostrados na tabela, para o ExecutorVM copiar as instruções
+    const std::vector<std::uint32_t>& pcsQuentes() const { return m_pcs_quentes; }
+    // O perfil só pode ser ligado/desligado com a máquina parada
+    void setColetaEditavel(bool editavel) { chkColetar->setEnabled(editavel); }
+
+signals:
+    void coletaAlterada(bool ligada);
+
+private:
+    const PerfilExecucao& m_perfil;
+
+    QCheckBox *chkColetar;
+    QLabel *lblMIPS;
+    GraficoMIPS *graficoMIPS;
+    GraficoBarras *graficoOpcodes;
+    QTableWidget *tblPCs;
+
+    QElapsedTimer m_relogio;
+    std::uint64_t m_instrucoes_amostra = 0;
+    std::vector<std::uint32_t> m_pcs_quentes;
+
+    std::uint64_t atualizarOpcodes();
+    void atualizarPCs(std::uint64_t total, const std::function<QString(std::uint32_t)>& instrucaoEm);
+};
+
+#endif //VM_SIC_PAINELDESEMPENHO_H
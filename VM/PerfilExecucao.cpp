@@ -0,0 +1,44 @@
+#include "PerfilExecucao.h"
+#include <algorithm>
+
+PerfilExecucao::PerfilExecucao(std::size_t tamanho_memoria_bytes) : m_pcs(tamanho_memoria_bytes) {
+}
+
+/*
+=========================================================================================
+Os n endereços mais executados. Percorre todos os contadores mantendo um heap de mínimo
+com os n maiores vistos até agora.
+=========================================================================================
+*/
+std::vector<PerfilExecucao::PCQuente> PerfilExecucao::maisExecutados(std::size_t n) const {
+    auto maisExecutado = [](const PCQuente& a, const PCQuente& b) { return a.execucoes > b.execucoes; };
+    std::vector<PCQuente> quentes;
+    if (n == 0) {
+        return quentes;
+    }
+    quentes.reserve(n + 1);
+
+    for (std::size_t pc = 0; pc < m_pcs.size(); ++pc) {
+        const std::uint64_t execucoes = m_pcs[pc].load(std::memory_order_relaxed);
+        if (execucoes == 0 || (quentes.size() == n && execucoes <= quentes.front().execucoes)) {
+            continue;
+        }
+        quentes.push_back({static_cast<std::uint32_t>(pc), execucoes});
+        std::push_heap(quentes.begin(), quentes.end(), maisExecutado);
+        if (quentes.size() > n) {
+            std::pop_heap(quentes.begin(), quentes.end(), maisExecutado);
+            quentes.pop_back();
+        }
+    }
+    std::sort_heap(quentes.begin(), quentes.end(), maisExecutado);
+    return quentes;
+}
+
+void PerfilExecucao::zerar() {
+    for (auto& contador : m_opcodes) {
+        contador.store(0, std::memory_order_relaxed);
+    }
+    for (auto& contador : m_pcs) {
+        contador.store(0, std::memory_order_relaxed);
+    }
+}
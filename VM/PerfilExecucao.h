@@ -0,0 +1,55 @@
+#ifndef VM_SIC_PERFILEXECUCAO_H
+#define VM_SIC_PERFILEXECUCAO_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Contadores de execução para o painel de desempenho: quantas vezes cada opcode e cada
+// endereço de instrução foram executados. Um único escritor (a thread da máquina, em
+// passo()) e leitores em outras threads: o escritor faz load + store relaxados em vez de
+// fetch_add, que custam o mesmo que um incremento comum, e os leitores veem cada
+// contador inteiro (talvez um pouco atrasado).
+class PerfilExecucao {
+public:
+    struct PCQuente {
+        std::uint32_t pc;
+        std::uint64_t execucoes;
+    };
+
+private:
+    std::array<std::atomic<std::uint64_t>, 64> m_opcodes{}; // por opcode >> 2
+    std::vector<std::atomic<std::uint64_t>> m_pcs;           // por endereço de byte
+
+    static void incrementar(std::atomic<std::uint64_t>& contador) {
+        contador.store(contador.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+public:
+    explicit PerfilExecucao(std::size_t tamanho_memoria_bytes);
+
+    // Escritor (Maquina::passo)
+    void registrar(std::size_t pc, std::uint8_t opcode) {
+        incrementar(m_opcodes[opcode >> 2]);
+        if (pc < m_pcs.size()) {
+            incrementar(m_pcs[pc]);
+        }
+    }
+
+    // Leitores
+    std::uint64_t execucoesDoOpcode(std::uint8_t opcode) const {
+        return m_opcodes[opcode >> 2].load(std::memory_order_relaxed);
+    }
+    std::uint64_t execucoesDoPC(std::size_t pc) const {
+        return pc < m_pcs.size() ? m_pcs[pc].load(std::memory_order_relaxed) : 0;
+    }
+    // Os 'n' endereços mais executados, do mais para o menos executado
+    std::vector<PCQuente> maisExecutados(std::size_t n) const;
+
+    // Só com a máquina parada
+    void zerar();
+};
+
+#endif //VM_SIC_PERFILEXECUCAO_H
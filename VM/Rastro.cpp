@@ -0,0 +1,199 @@
+#include "Rastro.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+static constexpr char ASSINATURA_RASTRO[8] = "SICRAST";
+
+std::uint8_t registradoresAlterados(const RegistroRastro& antes, const RegistroRastro& depois) {
+    std::uint8_t alterados = 0;
+    for (int r = 0; r < 6; ++r) {
+        if (antes.regs[r] != depois.regs[r]) {
+            alterados |= 1 << r;
+        }
+    }
+    if (antes.cc() != depois.cc()) {
+        alterados |= ALTEROU_CC;
+    }
+    return alterados;
+}
+
+/*
+=========================================================================================
+Gravação: o cabeçalho vai na abertura e os registros em blocos de REGISTROS_POR_ESCRITA.
+=========================================================================================
+*/
+GravadorRastro::GravadorRastro(const std::string& caminho) : m_arquivo(caminho, std::ios::binary | std::ios::trunc) {
+    if (!m_arquivo) {
+        throw std::runtime_error("Nao foi possivel criar o arquivo de rastro: " + caminho);
+    }
+    CabecalhoRastro cabecalho{};
+    std::memcpy(cabecalho.assinatura, ASSINATURA_RASTRO, sizeof cabecalho.assinatura);
+    cabecalho.versao = VERSAO_RASTRO;
+    cabecalho.tamanho_registro = sizeof(RegistroRastro);
+    m_arquivo.write(reinterpret_cast<const char*>(&cabecalho), sizeof cabecalho);
+    m_pendentes.reserve(REGISTROS_POR_ESCRITA);
+}
+
+GravadorRastro::~GravadorRastro() {
+    descarregar();
+}
+
+void GravadorRastro::descarregar() {
+    if (m_pendentes.empty()) {
+        return;
+    }
+    m_arquivo.write(reinterpret_cast<const char*>(m_pendentes.data()),
+                    static_cast<std::streamsize>(m_pendentes.size() * sizeof(RegistroRastro)));
+    m_arquivo.flush();
+    m_gravados += m_pendentes.size();
+    m_pendentes.clear();
+}
+
+/*
+=========================================================================================
+Leitura: só confere o cabeçalho. Um rastro interrompido no meio de um registro perde
+esse último registro incompleto.
+=========================================================================================
+*/
+LeitorRastro::LeitorRastro(const std::uint8_t* dados, std::size_t tamanho) {
+    CabecalhoRastro cabecalho;
+    if (tamanho < sizeof cabecalho) {
+        throw std::runtime_error("Arquivo pequeno demais para ser um rastro.");
+    }
+    std::memcpy(&cabecalho, dados, sizeof cabecalho);
+    if (std::memcmp(cabecalho.assinatura, ASSINATURA_RASTRO, sizeof cabecalho.assinatura) != 0) {
+        throw std::runtime_error("O arquivo nao e um rastro da VM.");
+    }
+    if (cabecalho.versao != VERSAO_RASTRO || cabecalho.tamanho_registro != sizeof(RegistroRastro)) {
+        throw std::runtime_error("Versao de rastro nao suportada.");
+    }
+    m_registros = reinterpret_cast<const RegistroRastro*>(dados + sizeof cabecalho);
+    m_quantidade = (tamanho - sizeof cabecalho) / sizeof(RegistroRastro);
+}
+
+/*
+=========================================================================================
+Índice esparso. A thread resume os blocos em ordem e publica cada um com release; quem
+consulta lê blocosProntos() com acquire e só usa os resumos abaixo dele.
+=========================================================================================
+*/
+IndiceRastro::IndiceRastro(const LeitorRastro& leitor)
+    : m_leitor(leitor),
+      m_blocos((leitor.getQuantidade() + REGISTROS_POR_BLOCO - 1) / REGISTROS_POR_BLOCO),
+      m_thread(&IndiceRastro::montar, this) {
+}
+
+IndiceRastro::~IndiceRastro() {
+    m_cancelar.store(true, std::memory_order_relaxed);
+    m_thread.join();
+}
+
+void IndiceRastro::montar() {
+    const std::size_t n = m_leitor.getQuantidade();
+    for (std::size_t b = 0; b < m_blocos.size(); ++b) {
+        if (m_cancelar.load(std::memory_order_relaxed)) {
+            return;
+        }
+        ResumoBloco& resumo = m_blocos[b];
+        const std::size_t fim = std::min(n, (b + 1) * REGISTROS_POR_BLOCO);
+        for (std::size_t i = b * REGISTROS_POR_BLOCO; i < fim; ++i) {
+            const RegistroRastro& reg = m_leitor[i];
+            const std::uint32_t pc = reg.pc();
+            resumo.opcodes |= std::uint64_t{1} << (reg.opcode() >> 2);
+            resumo.pc_min = std::min(resumo.pc_min, pc);
+            resumo.pc_max = std::max(resumo.pc_max, pc);
+            resumo.alterados |= m_leitor.alteradosPor(i);
+        }
+        m_prontos.store(b + 1, std::memory_order_release);
+    }
+}
+
+/*
+=========================================================================================
+Critérios de busca e filtro.
+=========================================================================================
+*/
+bool FiltroRastro::aceita(const LeitorRastro& leitor, std::size_t i) const {
+    switch (tipo) {
+        case Tipo::TODOS:
+            return true;
+        case Tipo::PC:
+            return leitor[i].pc() == valor;
+        case Tipo::OPCODE:
+            return leitor[i].opcode() == (valor & 0xFC);
+        case Tipo::REGISTRADOR:
+            return (leitor.alteradosPor(i) & valor) != 0;
+    }
+    return false;
+}
+
+bool FiltroRastro::blocoPodeConter(const IndiceRastro::ResumoBloco& resumo) const {
+    switch (tipo) {
+        case Tipo::TODOS:
+            return true;
+        case Tipo::PC:
+            return resumo.pc_min <= valor && valor <= resumo.pc_max;
+        case Tipo::OPCODE:
+            return (resumo.opcodes >> ((valor & 0xFC) >> 2)) & 1;
+        case Tipo::REGISTRADOR:
+            return (resumo.alterados & valor) != 0;
+    }
+    return true;
+}
+
+// Bloco resumido que com certeza não tem nada que satisfaça o filtro
+static bool blocoDescartado(const IndiceRastro& indice, const FiltroRastro& filtro, std::size_t bloco) {
+    return bloco < indice.blocosProntos() && !filtro.blocoPodeConter(indice.resumo(bloco));
+}
+
+std::size_t procurarRastro(const LeitorRastro& leitor, const IndiceRastro& indice, const FiltroRastro& filtro,
+                           std::size_t inicio, bool adiante) {
+    constexpr std::size_t K = IndiceRastro::REGISTROS_POR_BLOCO;
+    const std::size_t n = leitor.getQuantidade();
+    if (n == 0 || (adiante && inicio >= n)) {
+        return SEM_REGISTRO;
+    }
+    std::size_t i = std::min(inicio, n - 1);
+    while (true) {
+        const std::size_t bloco = i / K;
+        if (blocoDescartado(indice, filtro, bloco)) {
+            if (adiante) {
+                i = (bloco + 1) * K;
+                if (i >= n) return SEM_REGISTRO;
+            } else {
+                if (bloco == 0) return SEM_REGISTRO;
+                i = bloco * K - 1;
+            }
+            continue;
+        }
+        if (filtro.aceita(leitor, i)) {
+            return i;
+        }
+        if (adiante) {
+            if (++i >= n) return SEM_REGISTRO;
+        } else {
+            if (i == 0) return SEM_REGISTRO;
+            --i;
+        }
+    }
+}
+
+std::vector<std::uint32_t> filtrarRastro(const LeitorRastro& leitor, const IndiceRastro& indice,
+                                         const FiltroRastro& filtro) {
+    constexpr std::size_t K = IndiceRastro::REGISTROS_POR_BLOCO;
+    const std::size_t n = leitor.getQuantidade();
+    std::vector<std::uint32_t> aceitos;
+    for (std::size_t inicio = 0; inicio < n; inicio += K) {
+        if (blocoDescartado(indice, filtro, inicio / K)) {
+            continue;
+        }
+        const std::size_t fim = std::min(n, inicio + K);
+        for (std::size_t i = inicio; i < fim; ++i) {
+            if (filtro.aceita(leitor, i)) {
+                aceitos.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+    }
+    return aceitos;
+}
@@ -0,0 +1,148 @@
+#ifndef VM_SIC_RASTRO_H
+#define VM_SIC_RASTRO_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CPU.h"
+
+// Rastro binário de execução: um cabeçalho e um registro de tamanho fixo por instrução,
+// com o estado ANTES dela. O registro i fica em sizeof(CabecalhoRastro) + i * 32, então
+// o leitor vai a qualquer instrução sem índice; o que a instrução i mudou nos
+// registradores é a diferença entre os registros i e i+1.
+struct CabecalhoRastro {
+    char assinatura[8];              // "SICRAST"
+    std::uint32_t versao;
+    std::uint32_t tamanho_registro;
+    std::int32_t reservado[4];
+};
+
+struct RegistroRastro {
+    std::uint32_t pc_cc;   // bits 0-23: PC; 24-25: código de condição (0 menor, 1 igual, 2 maior)
+    std::uint8_t bytes[4]; // a instrução (bytes além do tamanho dela são zero)
+    std::int32_t regs[6];  // A, X, L, B, S, T
+
+    std::uint32_t pc() const { return pc_cc & 0xFFFFFF; }
+    std::uint8_t cc() const { return (pc_cc >> 24) & 0x3; }
+    std::uint8_t opcode() const { return bytes[0] & 0xFC; }
+};
+
+static_assert(sizeof(CabecalhoRastro) == 32, "cabeçalho do rastro com tamanho inesperado");
+static_assert(sizeof(RegistroRastro) == 32, "registro do rastro com tamanho inesperado");
+
+constexpr std::uint32_t VERSAO_RASTRO = 1;
+constexpr std::size_t SEM_REGISTRO = std::numeric_limits<std::size_t>::max();
+
+// Bits de registradoresAlterados: A..T na ordem de RegistroRastro::regs, e o código de condição
+constexpr std::uint8_t ALTEROU_CC = 1 << 6;
+std::uint8_t registradoresAlterados(const RegistroRastro& antes, const RegistroRastro& depois);
+
+// Escreve o rastro em blocos; usado por Maquina::passo() quando setRastro() recebe um
+class GravadorRastro {
+private:
+    static constexpr std::size_t REGISTROS_POR_ESCRITA = 8192;
+    std::ofstream m_arquivo;
+    std::vector<RegistroRastro> m_pendentes;
+    std::uint64_t m_gravados = 0;
+
+public:
+    explicit GravadorRastro(const std::string& caminho);
+    ~GravadorRastro();
+    GravadorRastro(const GravadorRastro&) = delete;
+    GravadorRastro& operator=(const GravadorRastro&) = delete;
+
+    void registrar(std::uint32_t pc, const std::uint8_t* bytes, std::uint8_t tamanho, const Registradores& r) {
+        RegistroRastro& reg = m_pendentes.emplace_back();
+        const std::uint32_t cc = r.SW == SMALLER ? 0 : (r.SW == EQUAL ? 1 : 2);
+        reg.pc_cc = (pc & 0xFFFFFF) | (cc << 24);
+        for (std::uint8_t k = 0; k < 4; ++k) {
+            reg.bytes[k] = k < tamanho ? bytes[k] : 0;
+        }
+        reg.regs[0] = r.A; reg.regs[1] = r.X; reg.regs[2] = r.L;
+        reg.regs[3] = r.B; reg.regs[4] = r.S; reg.regs[5] = r.T;
+        if (m_pendentes.size() == REGISTROS_POR_ESCRITA) {
+            descarregar();
+        }
+    }
+    void descarregar();
+    std::uint64_t getGravados() const { return m_gravados + m_pendentes.size(); }
+};
+
+// Vista de um rastro já na memória (em geral um arquivo mapeado); não copia nada
+class LeitorRastro {
+private:
+    const RegistroRastro* m_registros = nullptr;
+    std::size_t m_quantidade = 0;
+
+public:
+    LeitorRastro() = default;
+    // Lança std::runtime_error se os dados não forem um rastro desta versão
+    LeitorRastro(const std::uint8_t* dados, std::size_t tamanho);
+
+    std::size_t getQuantidade() const { return m_quantidade; }
+    const RegistroRastro& operator[](std::size_t i) const { return m_registros[i]; }
+    // Registradores mudados pela instrução i (0 para a última, que não tem sucessor)
+    std::uint8_t alteradosPor(std::size_t i) const {
+        return i + 1 < m_quantidade ? registradoresAlterados(m_registros[i], m_registros[i + 1]) : 0;
+    }
+};
+
+// Índice esparso: um resumo por bloco de REGISTROS_POR_BLOCO instruções, montado numa
+// thread própria logo na construção. Buscas e filtros pulam os blocos cujo resumo
+// garante que não há nada; blocos ainda não resumidos são varridos registro a registro.
+class IndiceRastro {
+public:
+    static constexpr std::size_t REGISTROS_POR_BLOCO = 4096;
+
+    struct ResumoBloco {
+        std::uint64_t opcodes = 0; // bit opcode >> 2
+        std::uint32_t pc_min = 0xFFFFFFFF;
+        std::uint32_t pc_max = 0;
+        std::uint8_t alterados = 0; // registradoresAlterados de alguma instrução do bloco
+    };
+
+private:
+    const LeitorRastro& m_leitor;
+    std::vector<ResumoBloco> m_blocos;
+    std::atomic<std::size_t> m_prontos{0};
+    std::atomic<bool> m_cancelar{false};
+    std::thread m_thread; // por último: começa depois dos outros membros existirem
+
+    void montar();
+
+public:
+    explicit IndiceRastro(const LeitorRastro& leitor);
+    ~IndiceRastro();
+    IndiceRastro(const IndiceRastro&) = delete;
+    IndiceRastro& operator=(const IndiceRastro&) = delete;
+
+    std::size_t getNumBlocos() const { return m_blocos.size(); }
+    std::size_t blocosProntos() const { return m_prontos.load(std::memory_order_acquire); }
+    // Só para bloco < blocosProntos()
+    const ResumoBloco& resumo(std::size_t bloco) const { return m_blocos[bloco]; }
+};
+
+// Critério das buscas e filtros do visualizador de rastro
+struct FiltroRastro {
+    enum class Tipo { TODOS, PC, OPCODE, REGISTRADOR };
+    Tipo tipo = Tipo::TODOS;
+    std::uint32_t valor = 0; // PC, opcode (sem os bits n/i) ou máscara de registradoresAlterados
+
+    bool aceita(const LeitorRastro& leitor, std::size_t i) const;
+    bool blocoPodeConter(const IndiceRastro::ResumoBloco& resumo) const;
+};
+
+// Próxima instrução que satisfaz 'filtro' a partir de 'inicio' (inclusive), para a frente
+// ou para trás; SEM_REGISTRO se não houver
+std::size_t procurarRastro(const LeitorRastro& leitor, const IndiceRastro& indice, const FiltroRastro& filtro,
+                           std::size_t inicio, bool adiante);
+// Todas as instruções que satisfazem 'filtro', em ordem
+std::vector<std::uint32_t> filtrarRastro(const LeitorRastro& leitor, const IndiceRastro& indice,
+                                         const FiltroRastro& filtro);
+
+#endif //VM_SIC_RASTRO_H
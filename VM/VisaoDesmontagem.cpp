@@ -0,0 +1,137 @@
+#include "VisaoDesmontagem.h"
+#include <QFontDatabase>
+#include <QPainter>
+#include <QScrollBar>
+#include <QSignalBlocker>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cstdlib>
+
+VisaoDesmontagem::VisaoDesmontagem(const Memoria& memoria, QWidget *parent)
+    : QAbstractScrollArea(parent), m_memoria(memoria), m_cache(memoria)
+{
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+
+    const int ultimo = static_cast<int>(std::max<std::size_t>(m_memoria.getTamanhoBytes(), 1) - 1);
+    verticalScrollBar()->setRange(0, ultimo);
+    verticalScrollBar()->setSingleStep(3);
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int valor) {
+        const std::uint32_t endereco = static_cast<std::uint32_t>(valor);
+        if (endereco == m_topo) {
+            return;
+        }
+        // Rodando, a memória não é lida: a linha fica onde a barra mandar
+        m_topo = m_executando ? endereco : m_cache.inicioDaInstrucao(endereco);
+        viewport()->update();
+    });
+}
+
+int VisaoDesmontagem::linhasVisiveis() const
+{
+    return std::max(1, viewport()->height() / fontMetrics().height());
+}
+
+void VisaoDesmontagem::sincronizarBarra()
+{
+    const QSignalBlocker bloqueio(verticalScrollBar());
+    verticalScrollBar()->setValue(static_cast<int>(m_topo));
+}
+
+void VisaoDesmontagem::setPC(std::int32_t pc)
+{
+    m_pc = pc;
+    const bool dentro = pc >= 0 && static_cast<std::size_t>(pc) < m_memoria.getTamanhoBytes();
+    if (dentro && !m_executando &&
+        (static_cast<std::uint32_t>(pc) < m_topo || static_cast<std::uint32_t>(pc) >= m_fim_visivel)) {
+        m_topo = static_cast<std::uint32_t>(pc);
+        sincronizarBarra();
+    }
+    viewport()->update();
+}
+
+void VisaoDesmontagem::setExecutando(bool executando)
+{
+    m_executando = executando;
+    viewport()->update();
+}
+
+void VisaoDesmontagem::invalidar(const std::vector<std::uint32_t>& enderecos)
+{
+    m_cache.invalidar(enderecos);
+    viewport()->update();
+}
+
+void VisaoDesmontagem::invalidarTudo()
+{
+    m_cache.invalidarTudo();
+    viewport()->update();
+}
+
+/*
+=========================================================================================
+Desenha a partir de m_topo, uma instrução por linha, até encher a tela. Só estas
+instruções são decodificadas (e ficam na cache para as próximas pinturas).
+=========================================================================================
+*/
+void VisaoDesmontagem::paintEvent(QPaintEvent *)
+{
+    QPainter painter(viewport());
+    painter.fillRect(viewport()->rect(), palette().color(QPalette::Base));
+    painter.setPen(palette().color(QPalette::Text));
+
+    const int altura = fontMetrics().height();
+    const std::size_t tamanho = m_memoria.getTamanhoBytes();
+    const int linhas = linhasVisiveis() + 1; // a última pode aparecer pela metade
+
+    std::uint32_t endereco = m_topo;
+    for (int k = 0; k < linhas && endereco < tamanho; ++k) {
+        const QRect retangulo(0, k * altura, viewport()->width(), altura);
+        const QString textoEndereco = QString("%1").arg(endereco, 5, 16, QChar('0')).toUpper();
+
+        const CacheDesmontagem::Linha *linha = m_executando ? m_cache.linhaEmCache(endereco) : &m_cache.linha(endereco);
+        if (!linha) { // rodando e fora da cache: sem o tamanho, não dá para seguir
+            painter.drawText(retangulo.adjusted(4, 0, 0, 0), Qt::AlignLeft | Qt::AlignVCenter, textoEndereco + "  ...");
+            break;
+        }
+
+        if (static_cast<std::int32_t>(endereco) == m_pc) {
+            painter.fillRect(retangulo, QColor(170, 200, 255));
+        }
+        QString bytes;
+        for (std::uint8_t b = 0; b < linha->tamanho; ++b) {
+            bytes += QString("%1 ").arg(static_cast<int>(linha->bytes[b]), 2, 16, QChar('0')).toUpper();
+        }
+        painter.drawText(retangulo.adjusted(4, 0, 0, 0), Qt::AlignLeft | Qt::AlignVCenter,
+                         QString("%1  %2 %3").arg(textoEndereco, bytes.leftJustified(12), QString::fromStdString(linha->texto)));
+        endereco += linha->tamanho;
+    }
+    m_fim_visivel = endereco;
+}
+
+void VisaoDesmontagem::resizeEvent(QResizeEvent *evento)
+{
+    QAbstractScrollArea::resizeEvent(evento);
+    verticalScrollBar()->setPageStep(linhasVisiveis() * 3); // ~3 bytes por instrução
+}
+
+// A roda anda de instrução em instrução (3 por passo da roda), não de byte em byte
+void VisaoDesmontagem::wheelEvent(QWheelEvent *evento)
+{
+    if (m_executando) {
+        evento->ignore();
+        return;
+    }
+    const int passos = -evento->angleDelta().y() / 40;
+    const std::uint32_t ultimo = static_cast<std::uint32_t>(m_memoria.getTamanhoBytes() - 1);
+    for (int k = 0; k < std::abs(passos); ++k) {
+        if (passos > 0) {
+            m_topo = std::min(ultimo, m_topo + m_cache.linha(m_topo).tamanho);
+        } else {
+            m_topo = m_cache.anterior(m_topo);
+        }
+    }
+    sincronizarBarra();
+    viewport()->update();
+    evento->accept();
+}
@@ -0,0 +1,46 @@
+#ifndef VM_SIC_VISAODESMONTAGEM_H
+#define VM_SIC_VISAODESMONTAGEM_H
+
+#include <QAbstractScrollArea>
+#include <cstdint>
+#include <vector>
+#include "CacheDesmontagem.h"
+#include "Memoria.h"
+
+// Desmontagem da memória, decodificada só para as linhas na tela. A barra de rolagem
+// anda em endereços de byte; a primeira linha é sempre alinhada ao início de uma
+// instrução (CacheDesmontagem::inicioDaInstrucao). Enquanto a máquina executa em outra
+// thread, só o que já está na cache é desenhado.
+class VisaoDesmontagem : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit VisaoDesmontagem(const Memoria& memoria, QWidget *parent = nullptr);
+
+    // Destaca a instrução do PC e rola até ela se estiver fora da tela
+    void setPC(std::int32_t pc);
+    void setExecutando(bool executando);
+
+    // Bytes escritos desde a última atualização (registro de escritas da Memoria)
+    void invalidar(const std::vector<std::uint32_t>& enderecos);
+    void invalidarTudo();
+
+protected:
+    void paintEvent(QPaintEvent *evento) override;
+    void resizeEvent(QResizeEvent *evento) override;
+    void wheelEvent(QWheelEvent *evento) override;
+
+private:
+    const Memoria& m_memoria;
+    CacheDesmontagem m_cache;
+    std::uint32_t m_topo = 0;        // endereço da primeira linha
+    std::uint32_t m_fim_visivel = 0; // endereço logo após a última linha desenhada
+    std::int32_t m_pc = -1;
+    bool m_executando = false;
+
+    int linhasVisiveis() const;
+    void sincronizarBarra();
+};
+
+#endif //VM_SIC_VISAODESMONTAGEM_H
@@ -0,0 +1,93 @@
+.        BIBHOST - rotinas de memória para programas convidados da VM SIC/XE
+.
+.        Cada macro expande para uma HCALL (BYTE X'E4nn', extensão desta máquina:
+.        rotina nativa sobre a memória) ou, com &HC=NAO, para o laço equivalente em
+.        SIC/XE, para montar o mesmo programa para uma máquina sem a extensão.
+.        Os endereços são rótulos e os tamanhos são constantes (imediatos).
+.
+.        Convenção da HCALL (ver ChamadaHost em Maquina_melhor.h):
+.          S = destino / primeira cadeia, X = origem / segunda cadeia,
+.          T = tamanho, A = byte de preenchimento
+.
+.        Como esta VM executa RSUB como fim de programa, as rotinas são macros e
+.        não sub-rotinas. Os laços usam só LDCH/STCH, imediatos e registradores
+.        (carga de palavra com n=i=1 é tratada como imediata nesta VM).
+.        Registradores alterados: A, S, T, X e SW.
+.
+.        HMOVER - copia &TAM bytes de &ORIG para &DEST (com a HCALL as regiões
+.        podem se sobrepor; o laço copia do início para o fim)
+HMOVER   MACRO  &DEST,&ORIG,&TAM,&HC=SIM
+         IF     (&HC EQ SIM)
+         +LDS   #&DEST
+         +LDA   #&ORIG
+         RMO    A,X
+         +LDT   #&TAM
+         BYTE   X'E401'
+         ELSE
+         LDA    #0
+         RMO    A,X
+         +LDT   #&TAM
+         COMPR  X,T
+         JEQ    $FIM
+$LACO    LDCH   &ORIG,X
+         STCH   &DEST,X
+         TIXR   T
+         JLT    $LACO
+$FIM     RMO    A,A
+         ENDIF
+         MEND
+.
+.        HPREENC - grava o byte &VALOR em &TAM bytes a partir de &DEST
+HPREENC  MACRO  &DEST,&VALOR,&TAM,&HC=SIM
+         IF     (&HC EQ SIM)
+         +LDS   #&DEST
+         LDA    #&VALOR
+         +LDT   #&TAM
+         BYTE   X'E402'
+         ELSE
+         LDA    #0
+         RMO    A,X
+         LDA    #&VALOR
+         +LDT   #&TAM
+         COMPR  X,T
+         JEQ    $FIM
+$LACO    STCH   &DEST,X
+         TIXR   T
+         JLT    $LACO
+$FIM     RMO    A,A
+         ENDIF
+         MEND
+.
+.        HCOMPAR - compara as cadeias terminadas em X'00' em &CAD1 e &CAD2;
+.        o SW fica como em COMP (&CAD1 : &CAD2), para JLT/JEQ/JGT logo depois
+HCOMPAR  MACRO  &CAD1,&CAD2,&HC=SIM
+         IF     (&HC EQ SIM)
+         +LDS   #&CAD1
+         +LDA   #&CAD2
+         RMO    A,X
+         BYTE   X'E403'
+         ELSE
+         LDA    #0
+         RMO    A,X
+$LACO    LDCH   &CAD1,X
+         RMO    A,S
+         LDCH   &CAD2,X
+         COMPR  S,A
+         JLT    $FIM
+         JGT    $FIM
+         COMP   #0
+         JEQ    $FIM
+         TIXR   X
+         J      $LACO
+$FIM     RMO    A,A
+         ENDIF
+         MEND
+.
+.        HORDENA - ordena &QTD palavras (24 bits, com sinal) a partir de &VETOR.
+.        Só existe com a HCALL: sem carga de palavra indexada não há laço portável
+.        para esta VM.
+HORDENA  MACRO  &VETOR,&QTD
+         +LDS   #&VETOR
+         +LDT   #&QTD
+         BYTE   X'E404'
+         MEND